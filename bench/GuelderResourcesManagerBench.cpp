@@ -0,0 +1,1105 @@
+#include "../include/GuelderResourcesManager.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//every allocation of the process is counted, so the benchmarks report how many allocations an operation makes
+namespace
+{
+    std::atomic<uint64_t> g_AllocationsCount = 0;
+    std::atomic<uint64_t> g_AllocatedBytes = 0;
+}
+
+void* operator new(size_t size)
+{
+    g_AllocationsCount.fetch_add(1, std::memory_order_relaxed);
+    g_AllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+    if(void* memory = std::malloc(size != 0 ? size : 1))
+        return memory;
+
+    throw std::bad_alloc{};
+}
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+void operator delete[](void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+//Usage: GuelderResourcesManagerBench [--filter=<substring>] [--min-time=<seconds>] [--samples=<count>] [--output=<file.json>] [--quick]
+//The results are printed as JSON to stdout (or to --output), the progress goes to stderr.
+//GuelderResourcesManagerBench --verify-format=<directory> runs no benchmarks, it checks that Parser::FormatScope turns every <name>.txt of the directory into <name>.expected
+//GuelderResourcesManagerBench --verify-schema-reopen runs no benchmarks, it checks that a Schema bound to a ConfigFile returns the values of the file after Reopen
+namespace
+{
+    using namespace GuelderResourcesManager;
+
+    using Clock = std::chrono::steady_clock;
+
+    //keeps the results alive, so the measured calls are not optimized out
+    volatile size_t g_Sink = 0;
+
+    template<typename T>
+    void Consume(const T& value)
+    {
+        if constexpr(requires { value.size(); })
+            g_Sink = g_Sink + value.size();
+        else
+            g_Sink = g_Sink + static_cast<size_t>(value);
+    }
+
+    struct Options
+    {
+        std::string filter;
+        std::string outputPath;
+        double minTime = 0.5;
+        uint32_t samples = 5;
+        //smaller configs, for a smoke run
+        bool isQuick = false;
+        std::string formatCorpusPath;
+        bool shouldVerifySchemaReopen = false;
+    };
+
+    struct BenchmarkResult
+    {
+        std::string name;
+        uint64_t iterations;
+        //median of the samples
+        double nsPerOperation;
+        double minNsPerOperation;
+        //0 if not set
+        double bytesPerSecond;
+        double itemsPerSecond;
+        //counted by the global operator new over all the samples
+        double allocationsPerOperation;
+        double allocatedBytesPerOperation;
+    };
+
+    //what one iteration of a benchmark does
+    struct Throughput
+    {
+        //nsPerOperation is divided by it
+        size_t operations = 1;
+        size_t bytes = 0;
+    };
+
+    class BenchmarkRunner
+    {
+    public:
+        explicit BenchmarkRunner(const Options& options)
+            : m_Options(options) {}
+
+        bool IsSelected(const std::string_view& name) const
+        {
+            return m_Options.filter.empty() || name.find(m_Options.filter) != std::string_view::npos;
+        }
+
+        //runs function in samples of the same amount of iterations, calibrated so all the samples take about minTime
+        template<typename Function>
+        void Run(const std::string& name, Function&& function, Throughput throughput = {})
+        {
+            if(!IsSelected(name))
+                return;
+
+            std::cerr << name << "... " << std::flush;
+
+            //the first call also warms up the caches
+            const auto calibrationBegin = Clock::now();
+            function();
+            const double firstCallTime = std::chrono::duration<double>(Clock::now() - calibrationBegin).count();
+
+            const double sampleTime = m_Options.minTime / m_Options.samples;
+            const uint64_t iterations = std::max<uint64_t>(1, static_cast<uint64_t>(sampleTime / std::max(firstCallTime, 1e-9)));
+
+            std::vector<double> nsPerOperation;
+            nsPerOperation.reserve(m_Options.samples);
+
+            const uint64_t allocationsCount = g_AllocationsCount.load(std::memory_order_relaxed);
+            const uint64_t allocatedBytes = g_AllocatedBytes.load(std::memory_order_relaxed);
+
+            for(uint32_t sample = 0; sample < m_Options.samples; sample++)
+            {
+                const auto begin = Clock::now();
+
+                for(uint64_t i = 0; i < iterations; i++)
+                    function();
+
+                const double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+
+                nsPerOperation.push_back(elapsed / static_cast<double>(iterations * throughput.operations));
+            }
+
+            std::sort(nsPerOperation.begin(), nsPerOperation.end());
+
+            const double operationsCount = static_cast<double>(iterations * m_Options.samples * throughput.operations);
+
+            const double allocationsPerOperation = (g_AllocationsCount.load(std::memory_order_relaxed) - allocationsCount) / operationsCount;
+            const double allocatedBytesPerOperation = (g_AllocatedBytes.load(std::memory_order_relaxed) - allocatedBytes) / operationsCount;
+
+            const double median = nsPerOperation[nsPerOperation.size() / 2];
+            const double nsPerIteration = median * throughput.operations;
+
+            AddResult(BenchmarkResult{
+                name,
+                iterations * m_Options.samples,
+                median,
+                nsPerOperation.front(),
+                throughput.bytes != 0 ? throughput.bytes * 1e9 / nsPerIteration : 0.0,
+                throughput.operations * 1e9 / nsPerIteration,
+                allocationsPerOperation,
+                allocatedBytesPerOperation
+                });
+        }
+
+        void AddResult(BenchmarkResult result)
+        {
+            std::cerr << std::format("{:.1f} ns/op, {:.1f} allocations/op\n", result.nsPerOperation, result.allocationsPerOperation);
+
+            m_Results.push_back(std::move(result));
+        }
+
+        std::string ToJSON() const
+        {
+            std::string json = "{\n";
+
+            json += "  \"schema_version\": 1,\n";
+            json += "  \"context\": {\n";
+            json += std::format("    \"hardware_concurrency\": {},\n", std::thread::hardware_concurrency());
+            json += std::format("    \"min_time_s\": {},\n", m_Options.minTime);
+            json += std::format("    \"samples\": {},\n", m_Options.samples);
+            json += std::format("    \"quick\": {}\n", m_Options.isQuick);
+            json += "  },\n";
+            json += "  \"benchmarks\": [\n";
+
+            for(size_t i = 0; i < m_Results.size(); i++)
+            {
+                const BenchmarkResult& result = m_Results[i];
+
+                json += std::format("    {{ \"name\": \"{}\", \"iterations\": {}, \"ns_per_op\": {:.3f}, \"min_ns_per_op\": {:.3f}, \"bytes_per_second\": {:.0f}, \"items_per_second\": {:.0f}, \"allocations_per_op\": {:.3f}, \"allocated_bytes_per_op\": {:.0f} }}{}\n",
+                    result.name, result.iterations, result.nsPerOperation, result.minNsPerOperation, result.bytesPerSecond, result.itemsPerSecond, result.allocationsPerOperation, result.allocatedBytesPerOperation, i + 1 < m_Results.size() ? "," : "");
+            }
+
+            json += "  ]\n}\n";
+
+            return json;
+        }
+
+    private:
+        Options m_Options;
+        std::vector<BenchmarkResult> m_Results;
+    };
+
+    struct ConfigShape
+    {
+        size_t variablesCount;
+        //how deep the namespaces are nested, 0 puts all the variables at the top level
+        uint32_t depth;
+        //every ARRAY_FREQUENCY-th variable is an array of this length, 0 means no arrays
+        uint32_t arrayLength;
+        //the share of the chars of string values that must be escaped
+        double escapeDensity;
+
+        std::string ToString() const
+        {
+            return std::format("vars={}/depth={}/array={}/escapes={}", variablesCount, depth, arrayLength, escapeDensity);
+        }
+    };
+
+    struct GeneratedConfig
+    {
+        std::string source;
+        //of every variable, in the order of the source
+        std::vector<std::string> paths;
+    };
+
+    //the same shape always gives the same config
+    class ConfigGenerator
+    {
+    public:
+        static constexpr size_t VARIABLES_PER_NAMESPACE = 16;
+        static constexpr size_t ARRAY_FREQUENCY = 8;
+        static constexpr size_t STRING_SIZE = 16;
+
+        //isCompact puts everything on one line, so FormatScope has to do the whole work
+        static GeneratedConfig Generate(const ConfigShape& shape, bool isCompact = false)
+        {
+            ConfigGenerator generator{ shape, isCompact };
+
+            //namespaces are opened in chains of shape.depth, every namespace of a chain has VARIABLES_PER_NAMESPACE variables
+            for(size_t chain = 0; generator.m_VariablesCount < shape.variablesCount; chain++)
+            {
+                if(shape.depth == 0)
+                {
+                    generator.AppendVariables(0, "");
+                    continue;
+                }
+
+                std::string namespacePath;
+
+                for(uint32_t level = 0; level < shape.depth && generator.m_VariablesCount < shape.variablesCount; level++)
+                {
+                    const std::string name = std::format("ns{}_{}", chain, level);
+
+                    generator.AppendLine(level, std::format("ns {} {{", name));
+                    namespacePath += name;
+                    namespacePath += ConfigFile::Parser::PATH_SEPARATOR;
+
+                    generator.AppendVariables(level + 1, namespacePath);
+                    generator.m_OpenedNamespaces++;
+                }
+
+                while(generator.m_OpenedNamespaces > 0)
+                {
+                    generator.m_OpenedNamespaces--;
+                    generator.AppendLine(generator.m_OpenedNamespaces, "}");
+                }
+            }
+
+            return std::move(generator.m_Config);
+        }
+
+        static std::string GenerateString(std::mt19937_64& random, size_t size, double escapeDensity)
+        {
+            static constexpr std::string_view PLAIN_CHARS = "abcdefghijklmnopqrstuvwxyz ,;{}";
+            static constexpr std::string_view SPECIAL_CHARS = "\"\\";
+
+            std::uniform_real_distribution<double> chance{ 0.0, 1.0 };
+
+            std::string result;
+            result.reserve(size);
+
+            for(size_t i = 0; i < size; i++)
+            {
+                if(chance(random) < escapeDensity)
+                    result += SPECIAL_CHARS[random() % SPECIAL_CHARS.size()];
+                else
+                    result += PLAIN_CHARS[random() % PLAIN_CHARS.size()];
+            }
+
+            return result;
+        }
+
+    private:
+        ConfigGenerator(const ConfigShape& shape, bool isCompact)
+            : m_Shape(shape), m_IsCompact(isCompact), m_Random(42), m_VariablesCount(0), m_OpenedNamespaces(0)
+        {
+            m_Config.paths.reserve(shape.variablesCount);
+        }
+
+        void AppendLine(size_t indentation, const std::string_view& line)
+        {
+            if(m_IsCompact)
+            {
+                m_Config.source += line;
+                return;
+            }
+
+            for(size_t i = 0; i < indentation; i++)
+                m_Config.source += ConfigFile::Parser::SCOPE_DISTANCE;
+
+            m_Config.source += line;
+            m_Config.source += ConfigFile::Parser::NEWLINE;
+        }
+        void AppendVariables(size_t indentation, const std::string& namespacePath)
+        {
+            for(size_t i = 0; i < VARIABLES_PER_NAMESPACE && m_VariablesCount < m_Shape.variablesCount; i++)
+            {
+                const size_t variableIndex = m_VariablesCount++;
+                const std::string name = std::format("v{}", variableIndex);
+                const bool isArray = m_Shape.arrayLength != 0 && variableIndex % ARRAY_FREQUENCY == 0;
+
+                //Int, Float, Bool, String in turn
+                const size_t kind = variableIndex % 4;
+                const std::string_view typeName = kind == 0 ? "Int" : kind == 1 ? "Float" : kind == 2 ? "Bool" : "String";
+
+                std::string value;
+
+                if(isArray)
+                {
+                    value += '{';
+
+                    for(uint32_t item = 0; item < m_Shape.arrayLength; item++)
+                    {
+                        if(item != 0)
+                            value += ", ";
+
+                        value += std::format("\"{}\"", GenerateValue(kind));
+                    }
+
+                    value += '}';
+                }
+                else
+                    value = std::format("\"{}\"", GenerateValue(kind));
+
+                AppendLine(indentation, std::format("{} {} = {};", typeName, name, value));
+
+                m_Config.paths.push_back(namespacePath + name);
+            }
+        }
+        //already escaped
+        std::string GenerateValue(size_t kind)
+        {
+            switch(kind)
+            {
+            case 0: return std::to_string(m_Random() % 100000);
+            case 1: return std::format("{:.3f}", std::uniform_real_distribution<double>{ 0.0, 1000.0 }(m_Random));
+            case 2: return m_Random() % 2 == 0 ? "true" : "false";
+            default: return ConfigFile::Parser::AddSpecialChars(GenerateString(m_Random, STRING_SIZE, m_Shape.escapeDensity));
+            }
+        }
+
+    private:
+        ConfigShape m_Shape;
+        bool m_IsCompact;
+        std::mt19937_64 m_Random;
+        GeneratedConfig m_Config;
+        size_t m_VariablesCount;
+        size_t m_OpenedNamespaces;
+    };
+
+    //removed with everything inside when destroyed
+    class TemporaryDirectory
+    {
+    public:
+        TemporaryDirectory()
+            : m_Path(std::filesystem::temp_directory_path() / std::format("GuelderResourcesManagerBench-{}", std::random_device{}()))
+        {
+            std::filesystem::create_directories(m_Path);
+        }
+        ~TemporaryDirectory()
+        {
+            std::error_code errorCode;
+            std::filesystem::remove_all(m_Path, errorCode);
+        }
+
+        TemporaryDirectory(const TemporaryDirectory& other) = delete;
+        TemporaryDirectory& operator=(const TemporaryDirectory& other) = delete;
+
+        std::filesystem::path WriteFile(const std::string_view& name, const std::string_view& content) const
+        {
+            const std::filesystem::path filePath = m_Path / name;
+
+            ResourcesManager::WriteToFile(filePath, content, SaveMode::InPlace);
+
+            return filePath;
+        }
+
+    private:
+        std::filesystem::path m_Path;
+    };
+
+    std::vector<ConfigShape> ReceiveParsingShapes(bool isQuick)
+    {
+        if(isQuick)
+            return { { 100, 2, 0, 0.0 }, { 2000, 4, 8, 0.05 } };
+
+        return {
+            { 100, 2, 0, 0.0 },
+            { 10000, 4, 8, 0.05 },
+            { 100000, 4, 8, 0.05 },
+            { 10000, 0, 8, 0.05 },
+            { 10000, 32, 8, 0.05 },
+            { 10000, 4, 256, 0.05 },
+            { 10000, 4, 8, 0.5 }
+        };
+    }
+
+    void BenchmarkParsing(BenchmarkRunner& runner, const Options& options)
+    {
+        for(const ConfigShape& shape : ReceiveParsingShapes(options.isQuick))
+        {
+            const std::string name = "ExtractVariablesFromString/" + shape.ToString();
+
+            if(!runner.IsSelected(name))
+                continue;
+
+            const GeneratedConfig config = ConfigGenerator::Generate(shape);
+
+            runner.Run(name, [&config] { Consume(ConfigFile::ExtractVariablesFromString(config.source)); }, { 1, config.source.size() });
+        }
+
+        //the first stage of the tokenizer on its own, with every instruction set the CPU supports. Reported in bytes per second, so GB/s can be compared with simdjson
+        const ConfigShape scanShape{ options.isQuick ? 2000u : 100000u, 4, 8, 0.05 };
+        const std::string scanSuffix = '/' + scanShape.ToString();
+
+        const GeneratedConfig scanConfig = ConfigGenerator::Generate(scanShape);
+
+        using InstructionSet = ConfigFile::Parser::InstructionSet;
+
+        for(const auto& [instructionSet, instructionSetName] : { std::pair{ InstructionSet::Scalar, "scalar" }, std::pair{ InstructionSet::SSE2, "sse2" }, std::pair{ InstructionSet::AVX2, "avx2" } })
+            if(instructionSet <= ConfigFile::Parser::ReceiveInstructionSet())
+                runner.Run(std::format("Parser::ScanStructure/{}{}", instructionSetName, scanSuffix), [&scanConfig, instructionSet] { Consume(ConfigFile::Parser::ScanStructure(scanConfig.source, instructionSet)); }, { 1, scanConfig.source.size() });
+
+        runner.Run("Parser::Tokenize" + scanSuffix, [&scanConfig] { Consume(ConfigFile::Parser::Tokenize(scanConfig.source)); }, { 1, scanConfig.source.size() });
+        runner.Run("Parser::SplitTopLevelScopes" + scanSuffix, [&scanConfig] { Consume(ConfigFile::Parser::SplitTopLevelScopes(scanConfig.source)); }, { 1, scanConfig.source.size() });
+    }
+
+    //the paths of a schema are known at compile time, so it reads a small config of its own
+    constexpr ConfigFile::SchemaField<int> SCHEMA_RESOLUTION{ "render/shadows/resolution", 2048 };
+    constexpr ConfigFile::SchemaField<float> SCHEMA_GAMMA{ "render/gamma", 2.2f };
+    constexpr ConfigFile::SchemaField<bool> SCHEMA_VSYNC{ "render/vsync", true };
+    constexpr ConfigFile::SchemaField<std::string_view> SCHEMA_TITLE{ "window/title", "" };
+
+    constexpr std::string_view SCHEMA_CONFIG_SOURCE = R"(ns render
+{
+    ns shadows
+    {
+        Int resolution = "4096";
+    }
+    Float gamma = "2.4";
+    Bool vsync = "false";
+}
+ns window
+{
+    String title = "bench";
+}
+)";
+
+    void BenchmarkLookups(BenchmarkRunner& runner, const Options& options, const TemporaryDirectory& directory)
+    {
+        constexpr size_t LOOKUPS_PER_ITERATION = 1024;
+
+        const ConfigShape shape{ options.isQuick ? 10000u : 100000u, 4, 8, 0.05 };
+
+        const GeneratedConfig config = ConfigGenerator::Generate(shape);
+        const std::filesystem::path configPath = directory.WriteFile("lookups.txt", config.source);
+
+        //random order, so the lookups don't walk the variables sequentially
+        std::vector<std::string> paths = config.paths;
+        std::shuffle(paths.begin(), paths.end(), std::mt19937_64{ 7 });
+        paths.resize(std::min(paths.size(), LOOKUPS_PER_ITERATION));
+
+        std::vector<std::string> missingPaths;
+        for(const std::string& path : paths)
+            missingPaths.push_back(path + "_missing");
+
+        for(const ConfigFile::StorageMode storageMode : { ConfigFile::StorageMode::Copy, ConfigFile::StorageMode::View })
+        {
+            const ConfigFile configFile{ configPath, false, storageMode };
+            const std::string_view modeName = storageMode == ConfigFile::StorageMode::Copy ? "copy" : "view";
+
+            runner.Run(std::format("GetVariable/{}/{}/hit", shape.ToString(), modeName), [&configFile, &paths]
+                {
+                    for(const std::string& path : paths)
+                        Consume(configFile.GetVariable(path).GetRawValue());
+                }, { paths.size() });
+        }
+
+        const ConfigFile configFile{ configPath, false };
+
+        runner.Run(std::format("GetVariable/{}/miss", shape.ToString()), [&configFile, &missingPaths]
+            {
+                for(const std::string& path : missingPaths)
+                {
+                    try
+                    {
+                        Consume(configFile.GetVariable(path).GetRawValue());
+                    }
+                    catch(const std::out_of_range&)
+                    {
+                    }
+                }
+            }, { missingPaths.size() });
+
+        const ConfigFile::Snapshot snapshot{ configFile.GetVariables() };
+
+        runner.Run(std::format("Snapshot::FindVariable/{}/miss", shape.ToString()), [&snapshot, &missingPaths]
+            {
+                for(const std::string& path : missingPaths)
+                    Consume(snapshot.FindVariable(path) != nullptr);
+            }, { missingPaths.size() });
+
+        runner.Run(std::format("ConfigFile::NamespaceTree/{}", shape.ToString()), [&configFile] { Consume(ConfigFile::NamespaceTree{ configFile.GetVariables() }.GetNodesCount()); });
+
+        //every variable under one top level namespace, by the NamespaceTree and by comparing the beginning of every path
+        const std::string& nestedPath = *std::ranges::find_if(config.paths, [](const std::string& path) { return path.contains(ConfigFile::Parser::PATH_SEPARATOR); });
+        const std::string namespacePath = nestedPath.substr(0, nestedPath.find(ConfigFile::Parser::PATH_SEPARATOR));
+        const std::string namespacePrefix = namespacePath + ConfigFile::Parser::PATH_SEPARATOR;
+
+        runner.Run(std::format("ConfigFile::GetVariablesUnder/{}", shape.ToString()), [&configFile, &namespacePath] { Consume(configFile.GetVariablesUnder(namespacePath)); });
+        runner.Run(std::format("ConfigFile::ForEachUnder/{}", shape.ToString()), [&configFile, &namespacePath]
+            {
+                size_t variablesCount = 0;
+
+                configFile.ForEachUnder(namespacePath, [&variablesCount](const Variable& variable) { variablesCount += !variable.GetRawValue().empty(); });
+
+                Consume(variablesCount);
+            });
+        runner.Run(std::format("GetVariables/prefix-scan/{}", shape.ToString()), [&configFile, &namespacePrefix]
+            {
+                std::vector<const Variable*> variables;
+
+                for(const Variable& variable : configFile.GetVariables())
+                    if(variable.GetPath().starts_with(namespacePrefix))
+                        variables.push_back(&variable);
+
+                Consume(variables);
+            });
+
+        using Schema = ConfigFile::Schema<SCHEMA_RESOLUTION, SCHEMA_GAMMA, SCHEMA_VSYNC, SCHEMA_TITLE>;
+
+        const ConfigFile schemaConfigFile{ directory.WriteFile("schema.txt", SCHEMA_CONFIG_SOURCE), false };
+        const Schema schema{ schemaConfigFile };
+
+        runner.Run("Schema::Bind/fields=4", [&schemaConfigFile] { Consume(Schema{ schemaConfigFile }.GetMismatches()); });
+        runner.Run("Schema::Get/fields=4", [&schema]
+            {
+                Consume(schema.Get<SCHEMA_RESOLUTION>() + schema.Get<SCHEMA_GAMMA>() + schema.Get<SCHEMA_VSYNC>() + schema.Get<SCHEMA_TITLE>().size());
+            }, { 4 });
+        //the same values the way they are read without a schema
+        runner.Run("GetVariable/GetValue/fields=4", [&schemaConfigFile]
+            {
+                Consume(schemaConfigFile.GetVariable(SCHEMA_RESOLUTION.path).GetValue<int>() + schemaConfigFile.GetVariable(SCHEMA_GAMMA.path).GetValue<float>() +
+                    schemaConfigFile.GetVariable(SCHEMA_VSYNC.path).GetValue<bool>() + schemaConfigFile.GetVariable(SCHEMA_TITLE.path).GetValue<std::string_view>().size());
+            }, { 4 });
+    }
+
+    //how Variable::GetArrayValue parsed numbers before the array cache: the value is scanned on every call and the escapes before each quote are counted backwards
+    template<IsNumber Numeral>
+    Variable::Array<Numeral> ReceiveArrayValueRescanning(const std::string_view& value)
+    {
+        using index = ConfigFile::Parser::index;
+
+        Variable::Array<Numeral> result;
+
+        index valueBegin = 0;
+        bool valueScopeClosed = true;
+
+        for(index i = 0; i < static_cast<index>(value.size()); i++)
+        {
+            if(value[i] == ConfigFile::Parser::VARIABLE_VALUE_SCOPE)
+            {
+                size_t specialCharSignCount = 0;
+                for(index j = i - 1; j > 0; j--)
+                {
+                    if(value[j] == ConfigFile::Parser::SPECIAL_CHAR_SIGN)
+                        specialCharSignCount++;
+                    else
+                        break;
+                }
+
+                if(specialCharSignCount % 2 == 0)
+                    valueScopeClosed = !valueScopeClosed;
+
+                if(!valueScopeClosed)
+                    valueBegin = i;
+                else
+                    result.push_back(StringToNumber<Numeral>(value.substr(valueBegin + 1, i - valueBegin - 1)));
+            }
+        }
+
+        return result;
+    }
+
+    void BenchmarkArrays(BenchmarkRunner& runner)
+    {
+        constexpr uint32_t ARRAY_LENGTH = 1000;
+
+        std::mt19937_64 random{ 3 };
+
+        std::vector<std::string> floats;
+        std::vector<std::string> strings;
+
+        for(uint32_t i = 0; i < ARRAY_LENGTH; i++)
+        {
+            floats.push_back(std::format("{:.3f}", std::uniform_real_distribution<double>{ 0.0, 1000.0 }(random)));
+            strings.push_back(ConfigFile::Parser::AddSpecialChars(ConfigGenerator::GenerateString(random, ConfigGenerator::STRING_SIZE, 0.05)));
+        }
+
+        //the same way the parser stores array values
+        const auto ToArrayValue = [](const std::vector<std::string>& items)
+            {
+                std::string value = "{";
+
+                for(size_t i = 0; i < items.size(); i++)
+                    value += std::format("{}\"{}\"", i != 0 ? ", " : "", items[i]);
+
+                return value + "}";
+            };
+
+        const Variable floatArray{ "floats", ToArrayValue(floats), DataType::Float, true };
+        const Variable stringArray{ "strings", ToArrayValue(strings), DataType::String, true };
+
+        const std::string suffix = std::format("/length={}", ARRAY_LENGTH);
+
+        runner.Run("GetArrayValue<float>" + suffix, [&floatArray] { Consume(floatArray.GetArrayValue<float>()); }, { 1, ARRAY_LENGTH * sizeof(float) });
+        runner.Run("GetArrayValue<float>/rescanning" + suffix, [&floatArray] { Consume(ReceiveArrayValueRescanning<float>(floatArray.GetRawValue())); }, { 1, ARRAY_LENGTH * sizeof(float) });
+        runner.Run("GetArrayValue<double>" + suffix, [&floatArray] { Consume(floatArray.GetArrayValue<double>()); }, { 1, ARRAY_LENGTH * sizeof(double) });
+        runner.Run("GetArraySpan<float>" + suffix, [&floatArray] { Consume(floatArray.GetArraySpan<float>()); });
+        runner.Run("GetArrayValue<std::string>" + suffix, [&stringArray] { Consume(stringArray.GetArrayValue<std::string>()); });
+        runner.Run("Variable/float-array-construction" + suffix, [&floatArray] { Consume(Variable{ "floats", std::string{ floatArray.GetRawValue() }, DataType::Float, true }.GetArraySpan<float>()); });
+    }
+
+    void BenchmarkWrites(BenchmarkRunner& runner, const Options& options)
+    {
+        constexpr size_t CHANGES_PER_TRANSACTION = 100;
+
+        const ConfigShape shape{ options.isQuick ? 1000u : 10000u, 4, 8, 0.05 };
+
+        const GeneratedConfig config = ConfigGenerator::Generate(shape);
+
+        //in a namespace in the middle of the source
+        const std::string& middlePath = config.paths[config.paths.size() / 2];
+        const std::string namespacePath = middlePath.substr(0, middlePath.rfind(ConfigFile::Parser::PATH_SEPARATOR) + 1);
+
+        const Variable newVariable{ namespacePath + "benchNew", "42", DataType::Int };
+        const Variable newNamespaceVariable{ "benchNamespace/benchNested/benchNew", "42", DataType::Int };
+
+        std::vector<Variable> newVariables;
+        std::vector<std::string_view> pathsToDelete;
+
+        for(size_t i = 0; i < CHANGES_PER_TRANSACTION; i++)
+        {
+            newVariables.emplace_back(std::format("{}benchNew{}", namespacePath, i), std::to_string(i), DataType::Int);
+            pathsToDelete.push_back(config.paths[i * config.paths.size() / CHANGES_PER_TRANSACTION]);
+        }
+
+        const std::string suffix = "/" + shape.ToString();
+
+        //the APIs take the source by value, so the copy is a part of every call
+        runner.Run("Parser::WriteVariable/existing-namespace" + suffix, [&] { Consume(ConfigFile::Parser::WriteVariable(config.source, newVariable)); }, { 1, config.source.size() });
+        runner.Run("Parser::WriteVariable/new-namespaces" + suffix, [&] { Consume(ConfigFile::Parser::WriteVariable(config.source, newNamespaceVariable)); }, { 1, config.source.size() });
+        runner.Run("Parser::DeleteVariable" + suffix, [&] { Consume(ConfigFile::Parser::DeleteVariable(config.source, middlePath)); }, { 1, config.source.size() });
+        runner.Run(std::format("Parser::ApplyChanges/writes={}/deletes={}{}", CHANGES_PER_TRANSACTION, CHANGES_PER_TRANSACTION, suffix),
+            [&] { Consume(ConfigFile::Parser::ApplyChanges(config.source, newVariables, pathsToDelete)); }, { 2 * CHANGES_PER_TRANSACTION, config.source.size() });
+
+        //Parser::FindVariableInfo fails to find some of the generated variables, so only the ones it finds are deleted
+        std::vector<std::string_view> foundPathsToDelete;
+        for(const std::string_view& path : pathsToDelete)
+        {
+            try
+            {
+                ConfigFile::Parser::FindVariableInfo(config.source, path);
+                foundPathsToDelete.push_back(path);
+            }
+            catch(const std::out_of_range&) {}
+        }
+
+        //the deletes one after another, every one either scans the source or uses the index that is built once for all of them
+        for(const bool isIndexed : { false, true })
+        {
+            runner.Run(std::format("Parser::DeleteVariable/{}/deletes={}{}", isIndexed ? "indexed" : "scanning", foundPathsToDelete.size(), suffix),
+                [&]
+                {
+                    std::string source = config.source;
+
+                    if(isIndexed)
+                    {
+                        ConfigFile::Parser::SourceIndex sourceIndex{ source };
+
+                        for(const std::string_view& path : foundPathsToDelete)
+                            source = ConfigFile::Parser::DeleteVariable(std::move(source), path, sourceIndex);
+                    }
+                    else
+                        for(const std::string_view& path : foundPathsToDelete)
+                            source = ConfigFile::Parser::DeleteVariable(std::move(source), path);
+
+                    Consume(source);
+                }, { foundPathsToDelete.size(), config.source.size() });
+        }
+    }
+
+    void BenchmarkFormatting(BenchmarkRunner& runner, const Options& options)
+    {
+        const std::vector<size_t> variablesCounts = options.isQuick ? std::vector<size_t>{ 1000 } : std::vector<size_t>{ 1000, 10000 };
+
+        for(const size_t variablesCount : variablesCounts)
+        {
+            const ConfigShape shape{ variablesCount, 4, 8, 0.05 };
+
+            for(const bool isCompact : { false, true })
+            {
+                const std::string name = std::format("Parser::FormatScope/{}/{}", isCompact ? "compact" : "formatted", shape.ToString());
+
+                if(!runner.IsSelected(name))
+                    continue;
+
+                const std::string source = ConfigGenerator::Generate(shape, isCompact).source;
+
+                runner.Run(name, [&source] { Consume(ConfigFile::Parser::FormatScope(source)); }, { 1, source.size() });
+            }
+        }
+    }
+
+    //returns the amount of the files which are formatted differently than expected
+    size_t VerifyFormatCorpus(const std::filesystem::path& directory)
+    {
+        size_t checkedCount = 0;
+        size_t mismatchesCount = 0;
+
+        for(const auto& entry : std::filesystem::directory_iterator{ directory })
+        {
+            const std::filesystem::path& inputPath = entry.path();
+
+            if(inputPath.extension() != ".txt")
+                continue;
+
+            std::filesystem::path expectedPath = inputPath;
+            expectedPath.replace_extension(".expected");
+
+            const std::string formatted = ConfigFile::Parser::FormatScope(ResourcesManager::ReceiveFileSource(inputPath));
+            const std::string expected = ResourcesManager::ReceiveFileSource(expectedPath);
+
+            checkedCount++;
+
+            if(formatted == expected)
+                continue;
+
+            mismatchesCount++;
+
+            const auto mismatch = std::mismatch(formatted.cbegin(), formatted.cend(), expected.cbegin(), expected.cend());
+            std::cerr << std::format("{}: differs from {} at char {}\n", inputPath.string(), expectedPath.filename().string(), mismatch.first - formatted.cbegin());
+        }
+
+        if(checkedCount == 0)
+            throw std::invalid_argument{ std::format("No .txt files in {}", directory.string()) };
+
+        std::cerr << std::format("{} of {} formatted as expected\n", checkedCount - mismatchesCount, checkedCount);
+
+        return mismatchesCount;
+    }
+
+    //returns the amount of the storage modes in which the schema returns stale values. Only the values change, so Reopen replaces the variables in place
+    size_t VerifySchemaReopen(const TemporaryDirectory& directory)
+    {
+        using Schema = ConfigFile::Schema<SCHEMA_RESOLUTION, SCHEMA_TITLE>;
+
+        size_t mismatchesCount = 0;
+
+        for(const ConfigFile::StorageMode storageMode : { ConfigFile::StorageMode::Copy, ConfigFile::StorageMode::View })
+        {
+            const std::string_view storageModeName = storageMode == ConfigFile::StorageMode::Copy ? "Copy" : "View";
+
+            ConfigFile configFile{ directory.WriteFile("schema-reopen.txt", "ns render { ns shadows { Int resolution = \"100\"; } }\nns window { String title = \"abc\"; }\n"), false, storageMode };
+            const Schema schema{ configFile };
+
+            directory.WriteFile("schema-reopen.txt", "ns render { ns shadows { Int resolution = \"200\"; } }\nns window { String title = \"xyz\"; }\n");
+
+            const size_t changedPathsCount = configFile.Reopen().size();
+
+            if(changedPathsCount == 2 && schema.Get<SCHEMA_RESOLUTION>() == 200 && schema.Get<SCHEMA_TITLE>() == "xyz" && schema.GetMismatches().empty())
+                continue;
+
+            mismatchesCount++;
+
+            std::cerr << std::format("{}: Reopen changed {} paths, the schema returns {} and \"{}\" instead of 200 and \"xyz\"\n", storageModeName, changedPathsCount, schema.Get<SCHEMA_RESOLUTION>(), schema.Get<SCHEMA_TITLE>());
+        }
+
+        std::cerr << std::format("{} of 2 storage modes read after Reopen as expected\n", 2 - mismatchesCount);
+
+        return mismatchesCount;
+    }
+
+    void BenchmarkEscaping(BenchmarkRunner& runner)
+    {
+        constexpr size_t VALUE_SIZE = 1024 * 1024;
+
+        for(const double escapeDensity : { 0.0, 0.1 })
+        {
+            const std::string suffix = std::format("/size=1MiB/escapes={}", escapeDensity);
+
+            std::mt19937_64 random{ 5 };
+
+            const std::string value = ConfigGenerator::GenerateString(random, VALUE_SIZE, escapeDensity);
+            const std::string escapedValue = ConfigFile::Parser::AddSpecialChars(value);
+
+            runner.Run("Parser::AddSpecialChars" + suffix, [&value] { Consume(ConfigFile::Parser::AddSpecialChars(value)); }, { 1, value.size() });
+            runner.Run("Parser::RemoveSpecialChars" + suffix, [&escapedValue] { Consume(ConfigFile::Parser::RemoveSpecialChars(escapedValue)); }, { 1, escapedValue.size() });
+        }
+    }
+
+    void BenchmarkFiles(BenchmarkRunner& runner, const Options& options, const TemporaryDirectory& directory)
+    {
+        const ConfigShape shape{ options.isQuick ? 10000u : 100000u, 4, 8, 0.05 };
+        const std::string suffix = "/" + shape.ToString();
+
+        const GeneratedConfig config = ConfigGenerator::Generate(shape);
+        const std::filesystem::path configPath = directory.WriteFile("files.txt", config.source);
+
+        runner.Run("ResourcesManager::ReceiveFileSource" + suffix, [&configPath] { Consume(ResourcesManager::ReceiveFileSource(configPath)); }, { 1, config.source.size() });
+        runner.Run("ResourcesManager::MappedFile" + suffix, [&configPath] { Consume(ResourcesManager::MappedFile{ configPath }.GetSource()); }, { 1, config.source.size() });
+
+        for(const SaveMode saveMode : { SaveMode::InPlace, SaveMode::Atomic })
+        {
+            const std::filesystem::path writtenPath = directory.WriteFile("written.txt", "");
+
+            runner.Run(std::format("ResourcesManager::WriteToFile/{}{}", saveMode == SaveMode::InPlace ? "in-place" : "atomic", suffix),
+                [&writtenPath, &config, saveMode] { ResourcesManager::WriteToFile(writtenPath, config.source, saveMode); }, { 1, config.source.size() });
+        }
+
+        runner.Run("ConfigFile/load" + suffix, [&configPath] { Consume(ConfigFile{ configPath, false }.GetVariables()); }, { 1, config.source.size() });
+        runner.Run("ConfigFile/load/view" + suffix, [&configPath] { Consume(ConfigFile{ configPath, false, ConfigFile::StorageMode::View }.GetVariables()); }, { 1, config.source.size() });
+
+        for(const uint32_t threadsCount : { 2u, 4u, 8u })
+        {
+            runner.Run(std::format("ConfigFile/load/threads={}{}", threadsCount, suffix),
+                [&configPath, threadsCount] { Consume(ConfigFile{ configPath, false, ConfigFile::StorageMode::Copy, false, threadsCount }.GetVariables()); }, { 1, config.source.size() });
+            runner.Run(std::format("ConfigFile/load/view/threads={}{}", threadsCount, suffix),
+                [&configPath, threadsCount] { Consume(ConfigFile{ configPath, false, ConfigFile::StorageMode::View, false, threadsCount }.GetVariables()); }, { 1, config.source.size() });
+        }
+
+        //the first load writes the cache
+        Consume(ConfigFile{ configPath, false, ConfigFile::StorageMode::Copy, true }.GetVariables());
+
+        runner.Run("ConfigFile/load/compiled-cache" + suffix, [&configPath] { Consume(ConfigFile{ configPath, false, ConfigFile::StorageMode::Copy, true }.GetVariables()); }, { 1, config.source.size() });
+        runner.Run("ConfigFile/load/compiled-cache/view" + suffix, [&configPath] { Consume(ConfigFile{ configPath, false, ConfigFile::StorageMode::View, true }.GetVariables()); }, { 1, config.source.size() });
+
+        //the same config with one value changed in the middle
+        std::string changedSource = config.source;
+        changedSource.insert(changedSource.find("= \"", changedSource.size() / 2) + 3, "1");
+
+        for(const ConfigFile::StorageMode storageMode : { ConfigFile::StorageMode::Copy, ConfigFile::StorageMode::View })
+        {
+            const std::string modeSuffix = storageMode == ConfigFile::StorageMode::View ? "/view" : "";
+            const std::filesystem::path reopenedPath = directory.WriteFile("reopened.txt", config.source);
+
+            ConfigFile configFile{ reopenedPath, false, storageMode };
+
+            runner.Run("ConfigFile::Reopen/unchanged" + modeSuffix + suffix, [&configFile] { Consume(configFile.Reopen()); }, { 1, config.source.size() });
+
+            //includes writing the file in place, see ResourcesManager::WriteToFile/in-place
+            bool isChanged = false;
+
+            runner.Run("ConfigFile::Reopen/one-value" + modeSuffix + suffix,
+                [&] {
+                    isChanged = !isChanged;
+                    ResourcesManager::WriteToFile(reopenedPath, isChanged ? changedSource : config.source, SaveMode::InPlace);
+                    Consume(configFile.Reopen());
+                }, { 1, config.source.size() });
+        }
+    }
+
+    //readers take the variables from SnapshotReaders while one writer commits transactions
+    void BenchmarkContention(BenchmarkRunner& runner, const Options& options, const TemporaryDirectory& directory)
+    {
+        constexpr size_t VARIABLES_COUNT = 1000;
+        constexpr std::string_view CHANGED_PATH = "ns0_0/benchChanged";
+
+        const std::chrono::duration<double> runTime{ options.minTime };
+
+        const GeneratedConfig config = ConfigGenerator::Generate({ VARIABLES_COUNT, 2, 0, 0.0 });
+
+        const uint32_t maxReadersCount = std::max(2u, std::thread::hardware_concurrency());
+
+        for(uint32_t readersCount = 1; readersCount <= maxReadersCount; readersCount *= 2)
+        {
+            const std::string name = std::format("Contention/SnapshotReader/readers={}", readersCount);
+
+            if(!runner.IsSelected(name))
+                continue;
+
+            std::cerr << name << "... " << std::flush;
+
+            ConfigFile configFile{ directory.WriteFile("contention.txt", config.source), false };
+            configFile.WriteVariable(Variable{ std::string{ CHANGED_PATH }, "0", DataType::Int });
+            configFile.EnableConcurrentReads();
+
+            std::atomic<bool> shouldStop = false;
+            std::atomic<uint64_t> readsCount = 0;
+
+            std::vector<std::jthread> readers;
+
+            for(uint32_t i = 0; i < readersCount; i++)
+            {
+                readers.emplace_back([&configFile, &config, &shouldStop, &readsCount, i]
+                    {
+                        ConfigFile::SnapshotReader reader{ configFile.GetSnapshotPublisher() };
+
+                        uint64_t reads = 0;
+
+                        for(size_t pathIndex = i; !shouldStop.load(std::memory_order_relaxed); pathIndex++, reads++)
+                            Consume(reader.GetSnapshot().GetVariable(config.paths[pathIndex % config.paths.size()]).GetRawValue());
+
+                        readsCount += reads;
+                    });
+            }
+
+            const auto begin = Clock::now();
+            uint64_t commitsCount = 0;
+
+            while(Clock::now() - begin < runTime)
+            {
+                configFile.BeginTransaction().DeleteVariable(CHANGED_PATH).WriteVariable(Variable{ std::string{ CHANGED_PATH }, std::to_string(++commitsCount), DataType::Int }).Commit();
+            }
+
+            shouldStop = true;
+            readers.clear();
+
+            const double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+
+            //per reader, so it stays flat if the reads scale
+            runner.AddResult(BenchmarkResult{
+                std::format("{}/commits_per_second={:.0f}", name, commitsCount * 1e9 / elapsed),
+                readsCount,
+                elapsed * readersCount / std::max<uint64_t>(readsCount, 1),
+                elapsed * readersCount / std::max<uint64_t>(readsCount, 1),
+                0.0,
+                readsCount * 1e9 / elapsed,
+                //the commits allocate, the readers don't
+                0.0,
+                0.0
+                });
+        }
+
+        //what publishing a snapshot adds to a commit of a big config
+        const GeneratedConfig bigConfig = ConfigGenerator::Generate({ options.isQuick ? 10000u : 200000u, 2, 0, 0.0 });
+
+        for(const bool isConcurrentReadsEnabled : { false, true })
+        {
+            const std::string name = std::format("Contention/Commit/concurrent_reads={}/vars={}", isConcurrentReadsEnabled, bigConfig.paths.size());
+
+            if(!runner.IsSelected(name))
+                continue;
+
+            ConfigFile configFile{ directory.WriteFile("contention-big.txt", bigConfig.source), false };
+            configFile.WriteVariable(Variable{ std::string{ CHANGED_PATH }, "0", DataType::Int });
+
+            if(isConcurrentReadsEnabled)
+                configFile.EnableConcurrentReads();
+
+            uint64_t commitsCount = 0;
+
+            runner.Run(name, [&configFile, &commitsCount, &CHANGED_PATH]
+                {
+                    configFile.BeginTransaction().DeleteVariable(CHANGED_PATH).WriteVariable(Variable{ std::string{ CHANGED_PATH }, std::to_string(++commitsCount), DataType::Int }).Commit();
+                });
+        }
+    }
+
+    //the same short commands one by one through ExecuteCommand and through CommandExecutors of different sizes, ns/op is per command
+    void BenchmarkCommands(BenchmarkRunner& runner, const Options& options)
+    {
+        const size_t commandsCount = options.isQuick ? 16 : 64;
+        const std::vector<std::string> arguments{ "echo", "bench" };
+
+        runner.Run(std::format("ExecuteCommand/serial/commands={}", commandsCount), [commandsCount, &arguments]
+            {
+                for(size_t i = 0; i < commandsCount; i++)
+                    Consume(ResourcesManager::ExecuteCommand(arguments)->outputs);
+            }, { commandsCount });
+
+#ifndef WIN32
+        for(const uint32_t maxProcesses : { 1u, 4u, 16u })
+        {
+            const std::string name = std::format("CommandExecutor/processes={}/commands={}", maxProcesses, commandsCount);
+
+            if(!runner.IsSelected(name))
+                continue;
+
+            ResourcesManager::CommandExecutor executor{ maxProcesses };
+
+            runner.Run(name, [commandsCount, &arguments, &executor]
+                {
+                    for(size_t i = 0; i < commandsCount; i++)
+                        executor.Submit(arguments, [](std::expected<ResourcesManager::CommandResult, std::string>&& result) { Consume(result->outputs); });
+
+                    executor.Wait();
+                }, { commandsCount });
+        }
+#endif
+    }
+
+    Options ParseOptions(int argc, char** argv)
+    {
+        Options options;
+
+        for(int i = 1; i < argc; i++)
+        {
+            const std::string_view argument = argv[i];
+
+            const auto ReceiveValue = [&argument](const std::string_view& name) -> std::optional<std::string_view>
+                {
+                    if(!argument.starts_with(name))
+                        return std::nullopt;
+
+                    return argument.substr(name.size());
+                };
+
+            if(const auto value = ReceiveValue("--filter="))
+                options.filter = *value;
+            else if(const auto value = ReceiveValue("--output="))
+                options.outputPath = *value;
+            else if(const auto value = ReceiveValue("--min-time="))
+                options.minTime = std::stod(std::string{ *value });
+            else if(const auto value = ReceiveValue("--samples="))
+                options.samples = std::max(1, std::stoi(std::string{ *value }));
+            else if(const auto value = ReceiveValue("--verify-format="))
+                options.formatCorpusPath = *value;
+            else if(argument == "--verify-schema-reopen")
+                options.shouldVerifySchemaReopen = true;
+            else if(argument == "--quick")
+                options.isQuick = true;
+            else
+                throw std::invalid_argument{ std::format("Unknown argument: {}", argument) };
+        }
+
+        return options;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const Options options = ParseOptions(argc, argv);
+
+        if(!options.formatCorpusPath.empty())
+            return VerifyFormatCorpus(options.formatCorpusPath) == 0 ? 0 : 1;
+
+        const TemporaryDirectory directory;
+
+        if(options.shouldVerifySchemaReopen)
+            return VerifySchemaReopen(directory) == 0 ? 0 : 1;
+
+        BenchmarkRunner runner{ options };
+
+        BenchmarkParsing(runner, options);
+        BenchmarkLookups(runner, options, directory);
+        BenchmarkArrays(runner);
+        BenchmarkWrites(runner, options);
+        BenchmarkFormatting(runner, options);
+        BenchmarkEscaping(runner);
+        BenchmarkFiles(runner, options, directory);
+        BenchmarkContention(runner, options, directory);
+        BenchmarkCommands(runner, options);
+
+        const std::string json = runner.ToJSON();
+
+        if(options.outputPath.empty())
+            std::cout << json;
+        else
+            std::ofstream{ options.outputPath } << json;
+    }
+    catch(const std::exception& exception)
+    {
+        std::cerr << exception.what() << '\n';
+
+        return 1;
+    }
+
+    return 0;
+}
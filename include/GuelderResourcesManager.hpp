@@ -7,6 +7,7 @@
 #include <limits>
 #include <vector>
 #include <memory>
+#include <memory_resource>
 #include <charconv>
 #include <stdexcept>
 #include <format>
@@ -16,6 +17,18 @@
 #include <filesystem>
 #include <expected>
 #include <future>
+#include <variant>
+#include <optional>
+#include <span>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <stop_token>
+#include <functional>
+#include <chrono>
+#include <tuple>
 
 #ifdef WIN32
 #include <Windows.h>
@@ -229,10 +242,45 @@ namespace GuelderResourcesManager
         default: return "Invalid";
         }
     }
+    //the DataType of a C++ type, e.g. DataType::Float for float
+    template<typename T>
+    constexpr DataType TypeToDataType() noexcept
+    {
+        if constexpr(std::is_same_v<T, int>) return DataType::Int;
+        else if constexpr(std::is_same_v<T, unsigned int>) return DataType::UInt;
+        else if constexpr(std::is_same_v<T, long>) return DataType::Long;
+        else if constexpr(std::is_same_v<T, unsigned long>) return DataType::ULong;
+        else if constexpr(std::is_same_v<T, long long>) return DataType::LongLong;
+        else if constexpr(std::is_same_v<T, unsigned long long>) return DataType::ULongLong;
+        else if constexpr(std::is_same_v<T, short>) return DataType::Short;
+        else if constexpr(std::is_same_v<T, unsigned short>) return DataType::UShort;
+        else if constexpr(std::is_same_v<T, char>) return DataType::Char;
+        else if constexpr(std::is_same_v<T, unsigned char>) return DataType::UChar;
+        else if constexpr(std::is_same_v<T, float>) return DataType::Float;
+        else if constexpr(std::is_same_v<T, double>) return DataType::Double;
+        else if constexpr(std::is_same_v<T, long double>) return DataType::LongDouble;
+        else if constexpr(std::is_same_v<T, bool>) return DataType::Bool;
+        else if constexpr(std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>) return DataType::String;
+        else return DataType::Invalid;
+    }
+
+    //how ResourcesManager::WriteToFile replaces the content of a file
+    enum class SaveMode : uint8_t
+    {
+        //truncates the file and writes it, readers may see a half-written file and a crash leaves it corrupted
+        InPlace = 0,
+        //writes a temporary file next to the original and renames it over the original, so the file is always either old or new
+        Atomic,
+        //the same, but the temporary file and the directory are flushed to the disk before returning, so the new file also survives a power loss. Slower
+        Durable
+    };
 
     struct ConfigFile
     {
     public:
+        //keeps the source and the interned strings of StorageMode::View variables alive, defined in the .cpp
+        struct ViewStorage;
+
         struct Parser
         {
         public:
@@ -266,7 +314,7 @@ namespace GuelderResourcesManager
                     if(begin >= 0 && end >= 0 && begin <= end)
                         return ReturnStringType{ string.data() + begin, string.data() + end + 1 };
                     else
-                        throw std::exception{ "invalid begin or end indices" };
+                        throw std::out_of_range{ "invalid begin or end indices" };
                 }
 
                 bool IsValid() const noexcept;
@@ -319,9 +367,111 @@ namespace GuelderResourcesManager
                 Namespace
             };
 
+            enum class TokenType : uint8_t
+            {
+                Invalid = 0,
+                Keyword,
+                Identifier,
+                //range includes both VARIABLE_VALUE_SCOPEs
+                String,
+                ScopeOpen,
+                ScopeClose,
+                Equals,
+                Semicolon,
+                ArrayItemsSeparator,
+                Comment
+            };
+            struct Token
+            {
+                TokenType type;
+                StringRange range;
+            };
+
+            //the indices of every namespace and variable of a source by their paths, so they are found without reparsing it.
+            //It is built once, then the Parser functions that take it update it after changing the source, by shifting the indices behind the change.
+            //Namespace paths have no trailing PATH_SEPARATOR. If a path repeats, the first one is found
+            struct SourceIndex
+            {
+            public:
+                SourceIndex() = default;
+                explicit SourceIndex(const std::string_view& scope);
+
+                //throws std::out_of_range if nothing is found
+                const NamespaceIndicesInfo& FindNamespace(const std::string_view& path) const;
+                //throws std::out_of_range if nothing is found
+                const VariableIndicesInfo& FindVariableInfo(const std::string_view& path) const;
+
+                bool DoesNamespaceExist(const std::string_view& path) const;
+                bool DoesVariableExist(const std::string_view& path) const;
+
+            private:
+                friend struct Parser;
+
+                struct PathHash
+                {
+                    using is_transparent = void;
+
+                    size_t operator()(const std::string_view& path) const noexcept;
+                };
+
+                //adds what is found in scope, which starts at offset in the whole source. path is the one of the namespace scope is in, with a trailing PATH_SEPARATOR
+                void Add(const std::string_view& scope, index offset, std::string path);
+                //every index that is not less than position is moved by offset
+                void Shift(index position, index offset);
+
+                //scope is the whole source after count chars were inserted at position
+                void OnInserted(const std::string_view& scope, index position, index count);
+                //scope is the whole source after the chars from begin to end (inclusive) were erased
+                void OnErased(const std::string_view& scope, index begin, index end);
+
+                std::unordered_map<std::string, NamespaceIndicesInfo, PathHash, std::equal_to<>> m_Namespaces;
+                std::unordered_map<std::string, VariableIndicesInfo, PathHash, std::equal_to<>> m_Variables;
+                //then the namespace an insertion lands in cannot be told by its path, so any change rebuilds the index
+                bool m_HasRepeatedPaths = false;
+            };
+
             static bool IsFullSubstringSame(const std::string_view& string, index stringIndexPosition, const std::string_view& substring);
 
+            //the instruction sets ScanStructure can use
+            enum class InstructionSet : uint8_t
+            {
+                Scalar = 0,
+                SSE2,
+                AVX2
+            };
+            //bitmasks of 64 chars of a source, the first char is the lowest bit
+            struct StructuralBlock
+            {
+                //the chars Tokenize stops at outside of strings and comments: SCOPE_OPEN, SCOPE_CLOSE, EQUALS, SEMICOLON, ARRAY_ITEMS_SEPARATOR,
+                //VARIABLE_VALUE_SCOPE, the first char of COMMENT_SCOPE_LINE and the first char of every word
+                uint64_t events;
+                //VARIABLE_VALUE_SCOPEs after an even amount of SPECIAL_CHAR_SIGNs, so they close a string
+                uint64_t closingQuotes;
+                uint64_t newlines;
+                //Variable::IsValidVariableChar
+                uint64_t variableChars;
+            };
+
+            //the best instruction set the CPU supports, it is checked once
+            static InstructionSet ReceiveInstructionSet() noexcept;
+            //the first stage of Tokenize: classifies every char with SIMD, so Tokenize jumps from one event to the next instead of looking at every char.
+            //The chars after the end of scope are zeros. Throws std::invalid_argument if the CPU doesn't support instructionSet
+            static std::vector<StructuralBlock> ScanStructure(const std::string_view& scope, InstructionSet instructionSet = ReceiveInstructionSet());
+            //the same, but into blocks, which is reused
+            static void ScanStructure(const std::string_view& scope, std::vector<StructuralBlock>& blocks, InstructionSet instructionSet = ReceiveInstructionSet());
+
+            //one pass over the source, whitespaces are skipped
+            static std::vector<Token> Tokenize(const std::string_view& scope);
+            //the same, but tokens and blocks are reused, so tokenizing many scopes one after another doesn't allocate for each of them
+            static void Tokenize(const std::string_view& scope, std::vector<Token>& tokens, std::vector<StructuralBlock>& blocks);
+            //splits scope after every SCOPE_CLOSE that closes a top level scope (or after the SEMICOLON that follows it), without tokenizing it. The ranges cover the whole scope
+            static std::vector<StringRange> SplitTopLevelScopes(const std::string_view& scope);
+
             static void ProcessNamespace(std::vector<Variable>& variables, std::string& path, const std::string_view& scope);
+            //path is used as a prefix for every variable found in tokens.
+            //If viewStorage is set, variables are created as views: scope must be owned by viewStorage or by the storage it keeps.
+            //Returns false if the tokens end inside a namespace or a statement, so the tokens after them would change the result
+            static bool ProcessTokens(std::vector<Variable>& variables, std::string& path, const std::string_view& scope, const std::vector<Token>& tokens, const std::shared_ptr<ViewStorage>& viewStorage = nullptr);
 
             static NamespaceIndicesInfo ReceiveNamespaceInfo(const std::string_view& scope, const index& namespaceKeywordBeginIndex);
             //if the variable is empty e.g. "", VariableIndicesInfo::value indices will be equal to std::string::npos
@@ -359,17 +509,33 @@ namespace GuelderResourcesManager
             /// @param before path to variable or namespace
             /// @return 
             static std::string WriteVariablesBefore(std::string scope, const std::vector<Variable>& variables, const std::string_view& before, StringRange scopeRange = {});
+            //the same as above, but after is found by sourceIndex, which is updated to the returned scope
+            static std::string WriteVariableAfter(std::string scope, const Variable& variable, const std::string_view& after, SourceIndex& sourceIndex);
+            //the same as above, but before is found by sourceIndex, which is updated to the returned scope
+            static std::string WriteVariableBefore(std::string scope, const Variable& variable, const std::string_view& before, SourceIndex& sourceIndex);
 
             //may throw an exception
             static std::string DeleteNamespace(std::string scope, const std::string_view& path);
             //may throw an exception
             static std::string DeleteVariable(std::string scope, const std::string_view& path);
+            //the same as above, but the namespace is found by sourceIndex, which is updated to the returned scope
+            static std::string DeleteNamespace(std::string scope, const std::string_view& path, SourceIndex& sourceIndex);
+            //the same as above, but the variable is found by sourceIndex, which is updated to the returned scope
+            static std::string DeleteVariable(std::string scope, const std::string_view& path, SourceIndex& sourceIndex);
+            //deletes the variables, then writes the new ones (creating missing namespaces) in one pass over scope, without reparsing it for every change.
+            //Throws std::invalid_argument if a variable to delete is not found
+            static std::string ApplyChanges(const std::string_view& scope, const std::vector<Variable>& variablesToWrite, const std::vector<std::string_view>& pathsToDelete = {});
             //makes beauty
             static std::string FormatScope(std::string scope, StringRange range = {});
 
             //makes from <f""fff> -> <f\"\"fff> so it is usable for config and variable value string.
             //This assumes that variableValue is not already populated with SPECIAL_CHAR_SIGH, so if variableValue == "\\", then output will be "\\\\", but NOT "\\"
             static std::string AddSpecialChars(std::string variableValue);
+            //makes from <f\"\"fff> -> <f""fff>, the reverse of AddSpecialChars. Both are done in one pass
+            static std::string RemoveSpecialChars(const std::string_view& variableValue);
+            //writes to output, which must have at least variableValue.size() chars. Returns the amount of written chars
+            static size_t RemoveSpecialChars(const std::string_view& variableValue, char* output);
+            static bool IsSpecialChar(char ch) noexcept;
 
             static size_t DetermineReserveSize(const Variable& variable);
 
@@ -407,29 +573,364 @@ namespace GuelderResourcesManager
         private:
             //this func basically needs an outer index of the scope, and those bools. This func finds out whether current char is about namespace or variable or other shit
             static ParsingDataType DetermineParsingDataType(const std::string_view& scope, index currentCharIndex, bool& wasCommentScopeClosed, bool& wasValueScopeClosed);
+            //isEscaped tells whether the char before currentCharIndex is SPECIAL_CHAR_SIGN (or there is no char before it), for when that char is not in scope
+            static ParsingDataType DetermineParsingDataType(const std::string_view& scope, index currentCharIndex, bool isEscaped, bool& wasCommentScopeClosed, bool& wasValueScopeClosed);
             static bool IsArray(const std::string_view& variableValue);
 
-            static index FormatScope(std::string& scope, StringRange& namespaceScope, index scopesOpened, bool wasNewLine = false);
+            //the formatted output followed by the rest of the source, defined in the .cpp
+            struct FormattingBuffer;
+
+            static index FormatScope(FormattingBuffer& scope, StringRange& namespaceScope, index scopesOpened, bool wasNewLine = false);
+
+            //insertIndex is where the variable (or the namespaces created for it) is inserted
+            static std::string WriteVariable(std::string scope, const Variable& variable, StringRange scopeRange, index& insertIndex);
+
+            //fills the scope range (from SCOPE_OPEN to SCOPE_CLOSE) of every namespace and the range of every variable (from the type to the semicolon) by their paths.
+            //Namespace paths have no trailing PATH_SEPARATOR. If a path repeats, the first one is kept
+            static void ReceiveScopeLayout(const std::string_view& scope, const std::vector<Token>& tokens, std::unordered_map<std::string, StringRange>& namespaceScopes, std::unordered_map<std::string, StringRange>& variableRanges);
 
             static StringRange CorrectStringRange(index scopeEnd, StringRange stringRange);
             static StringRange CorrectStringRange(const std::string_view& scope, const StringRange& stringRange);
         };
     public:
-        ConfigFile(std::filesystem::path configFilePath, bool createOrOpen = true);
+        //stages writes and deletes, Commit applies them to the file at once: the file is read and written only one time
+        struct Transaction
+        {
+        public:
+            ~Transaction() = default;
+
+            Transaction(const Transaction& other) = delete;
+            Transaction(Transaction&& other) noexcept = default;
+            Transaction& operator=(const Transaction& other) = delete;
+            Transaction& operator=(Transaction&& other) noexcept = default;
+
+            //throws std::invalid_argument if the variable path is already taken, including the staged writes
+            Transaction& WriteVariable(Variable variable);
+            //throws std::invalid_argument if the variable doesn't exist, including the staged deletes
+            Transaction& DeleteVariable(const std::string_view& path);
+
+            //writes the file and updates the variables of the ConfigFile. If it throws, neither is changed. The transaction is empty afterwards
+            void Commit();
+            //drops the staged changes
+            void Rollback() noexcept;
+
+            bool IsEmpty() const noexcept;
+
+        private:
+            friend struct ConfigFile;
+
+            explicit Transaction(ConfigFile& configFile);
+
+            bool DoesVariableExist(const std::string_view& path) const;
+
+        private:
+            ConfigFile* m_ConfigFile;
+
+            std::vector<Variable> m_VariablesToWrite;
+            std::vector<std::string> m_PathsToDelete;
+            //whether the path exists after the staged changes, only for the paths that have been staged
+            std::unordered_map<std::string, bool> m_StagedPaths;
+        };
+
+    public:
+        enum class StorageMode : uint8_t
+        {
+            //every variable owns its path and value in its own block, so it keeps only them alive
+            Copy = 0,
+            //variables point into the loaded source, which they keep alive. Only values with special chars and full paths are allocated, in one pool
+            View
+        };
+
+    private:
+        static constexpr size_t EMPTY_VARIABLE_INDEX = std::numeric_limits<size_t>::max();
+
+        //open addressing hash table of indices into a vector of variables, hashed by the variable path. It doesn't store keys, so it costs one allocation in total
+        struct VariablesIndex
+        {
+            //returns EMPTY_VARIABLE_INDEX if nothing is found
+            size_t Find(const std::vector<Variable>& variables, const std::string_view& variablePath) const noexcept;
+            //rebuilds the table from scratch
+            void Update(const std::vector<Variable>& variables);
+            //adds the variable that is already in variables
+            void Add(const std::vector<Variable>& variables, size_t variableIndex);
+
+            std::vector<size_t> slots;
+        };
+
+    public:
+        //immutable variables, so a snapshot can be read from any thread without locking
+        struct Snapshot
+        {
+        public:
+            explicit Snapshot(std::vector<Variable> variables);
+
+            //throws std::out_of_range if nothing is found
+            const Variable& GetVariable(const std::string_view& variablePath) const;
+            //returns nullptr if nothing is found
+            const Variable* FindVariable(const std::string_view& variablePath) const noexcept;
+            const std::vector<Variable>& GetVariables() const noexcept;
+
+        private:
+            friend struct ConfigFile;
+
+            //variablesIndex is already built for variables, e.g. the index of the ConfigFile
+            Snapshot(std::vector<Variable> variables, VariablesIndex variablesIndex);
+
+        private:
+            std::vector<Variable> m_Variables;
+            VariablesIndex m_VariablesIndex;
+        };
+
+        //shares the latest snapshot with the readers on other threads. Publishing doesn't wait for the readers and the readers don't wait for anything
+        struct SnapshotPublisher
+        {
+        public:
+            SnapshotPublisher(std::shared_ptr<const Snapshot> snapshot = nullptr);
+
+            SnapshotPublisher(const SnapshotPublisher& other) = delete;
+            SnapshotPublisher(SnapshotPublisher&& other) = delete;
+            SnapshotPublisher& operator=(const SnapshotPublisher& other) = delete;
+            SnapshotPublisher& operator=(SnapshotPublisher&& other) = delete;
+
+            //returns the previous snapshot
+            std::shared_ptr<const Snapshot> Publish(std::shared_ptr<const Snapshot> snapshot) noexcept;
+
+            std::shared_ptr<const Snapshot> GetSnapshot() const noexcept;
+            //incremented by every Publish, after the snapshot is stored
+            uint64_t GetVersion() const noexcept;
+
+        private:
+            std::atomic<std::shared_ptr<const Snapshot>> m_Snapshot;
+            std::atomic<uint64_t> m_Version;
+        };
+        //a per thread cache of the published snapshot. While nothing new is published, reading only loads the version,
+        //so the readers don't fight over the reference count of the snapshot and scale with the amount of cores
+        struct SnapshotReader
+        {
+        public:
+            //the publisher must outlive the reader
+            explicit SnapshotReader(const SnapshotPublisher& publisher);
+
+            //valid until the next call
+            const Snapshot& GetSnapshot();
+
+        private:
+            const SnapshotPublisher* m_Publisher;
+
+            uint64_t m_Version;
+            std::shared_ptr<const Snapshot> m_Snapshot;
+        };
+
+        //reloads the variables of a config file on a background thread when the file changes: with inotify on Linux, by polling the write time otherwise or if inotify fails.
+        //A reload publishes a new snapshot, so readers never wait for it and keep using the snapshot they have got
+        struct Watcher
+        {
+        public:
+            //variable is nullptr if it has been deleted. Called on the thread that reloads, after the new snapshot is published
+            using Callback = std::function<void(const Variable* variable)>;
+
+            static constexpr std::chrono::milliseconds DEFAULT_POLLING_INTERVAL{ 500 };
+
+            //loads the file on the calling thread, throws if it cannot be read
+            Watcher(std::filesystem::path configFilePath, StorageMode storageMode = StorageMode::Copy, std::chrono::milliseconds pollingInterval = DEFAULT_POLLING_INTERVAL);
+            //stops the thread and waits for it
+            ~Watcher();
+
+            Watcher(const Watcher& other) = delete;
+            Watcher(Watcher&& other) = delete;
+            Watcher& operator=(const Watcher& other) = delete;
+            Watcher& operator=(Watcher&& other) = delete;
+
+            std::shared_ptr<const Snapshot> GetSnapshot() const noexcept;
+            //the amount of published snapshots, including the first one
+            uint64_t GetVersion() const noexcept;
+            //for SnapshotReader
+            const SnapshotPublisher& GetSnapshotPublisher() const noexcept;
+            const std::filesystem::path& GetPath() const noexcept;
+
+            //callback is called when the variable with variablePath is added, changed or deleted. Returns the id for Unsubscribe
+            size_t Subscribe(std::string variablePath, Callback callback);
+            //the callback may still be running on the watcher thread when this returns
+            void Unsubscribe(size_t subscriptionID);
+
+            //reloads on the calling thread without waiting for the watcher, throws if the file cannot be read
+            void Reload();
+
+        private:
+            //watchStarted is set once the changes are watched, so the first load cannot miss a change
+            void Run(std::stop_token stopToken, std::shared_ptr<std::promise<void>> watchStarted);
+            //returns false if inotify cannot be used, so the file has to be polled
+            bool WatchWithInotify(const std::stop_token& stopToken, std::shared_ptr<std::promise<void>>& watchStarted);
+            void WatchWithPolling(const std::stop_token& stopToken, std::shared_ptr<std::promise<void>>& watchStarted);
+
+            //if the file cannot be read, e.g. in the middle of saving, the old snapshot stays
+            void TryReload() noexcept;
+            void Notify(const Snapshot& oldSnapshot, const Snapshot& newSnapshot);
+
+        private:
+            std::filesystem::path m_Path;
+            StorageMode m_StorageMode;
+            std::chrono::milliseconds m_PollingInterval;
+
+            SnapshotPublisher m_SnapshotPublisher;
+            //only the reloads wait for each other
+            std::mutex m_ReloadMutex;
+
+            std::mutex m_SubscriptionsMutex;
+            std::unordered_map<std::string, std::vector<std::pair<size_t, Callback>>> m_Subscriptions;
+            size_t m_LastSubscriptionID;
+
+            //the last one, so the thread is stopped before the other members are destroyed
+            std::jthread m_Thread;
+        };
+
+        //the parsed variables in a binary file next to the config file: a table of paths, types and pre-parsed numbers plus one blob of strings.
+        //Reading it only maps the file and creates the variables, StorageMode::View variables point right into the mapping
+        struct CompiledCache
+        {
+        public:
+            //the cache is used only if all of them match the source it was written for
+            struct SourceKey
+            {
+                uint64_t size;
+                int64_t writeTime;
+                uint64_t hash;
+
+                bool operator==(const SourceKey& other) const = default;
+            };
+
+            //<configFilePath>.compiled
+            static std::filesystem::path GetCachePath(const std::filesystem::path& configFilePath);
+            //writeTime must be received before the source is read, so a source changed in between never matches
+            static SourceKey ReceiveSourceKey(const std::string_view& source, std::filesystem::file_time_type writeTime) noexcept;
+
+            //throws std::filesystem::filesystem_error or std::ios::failure. The file is replaced atomically, so the mapped caches stay valid
+            static void Write(const std::filesystem::path& cachePath, const SourceKey& sourceKey, const std::vector<Variable>& variables);
+            //returns std::nullopt if the cache doesn't exist, is written for another source or by an incompatible build, or is corrupted
+            static std::optional<std::vector<Variable>> Read(const std::filesystem::path& cachePath, const SourceKey& sourceKey, StorageMode storageMode);
+        };
+
+        //the namespaces of a vector of variables, every namespace path is interned once. A node knows its parent, its child namespaces and its own variables.
+        //Nodes are numbered depth first with the children sorted by name, so the nodes under a namespace and the indices of their variables are contiguous.
+        //It is only for lookups: every Variable keeps its full path, the tree is stored next to them and doesn't make the variables smaller
+        struct NamespaceTree
+        {
+        public:
+            //the global namespace, its path is empty
+            static constexpr size_t ROOT_NODE = 0;
+            static constexpr size_t EMPTY_NODE = std::numeric_limits<size_t>::max();
+
+            //only the root
+            NamespaceTree();
+            explicit NamespaceTree(const std::vector<Variable>& variables);
+
+            //namespacePath may end with PATH_SEPARATOR, "" is the root. Returns EMPTY_NODE if no variable is in the namespace or under it
+            size_t Find(const std::string_view& namespacePath) const noexcept;
+
+            //the full path of the namespace, without a trailing PATH_SEPARATOR
+            std::string_view GetPath(size_t node) const;
+            //the last part of the path
+            std::string_view GetName(size_t node) const;
+            //EMPTY_NODE for the root
+            size_t GetParent(size_t node) const;
+            //the nodes of the child namespaces are from node + 1 to GetSubtreeEnd(node), the children are among them
+            std::vector<size_t> GetChildren(size_t node) const;
+            //the node after the last one under node
+            size_t GetSubtreeEnd(size_t node) const;
+            //indices into the variables the tree is built from, in their order
+            std::span<const size_t> GetVariableIndices(size_t node) const;
+            //the same, but the variables of every namespace under node are included
+            std::span<const size_t> GetVariableIndicesUnder(size_t node) const;
+            size_t GetNodesCount() const noexcept;
+
+        private:
+            struct Node
+            {
+                //the path is in m_Paths, the name is its end
+                uint32_t pathBegin;
+                uint32_t pathSize;
+                uint32_t nameSize;
+                uint32_t parent;
+                uint32_t subtreeEnd;
+                //into m_VariableIndices. The variables of the subtree end where the ones of subtreeEnd begin
+                uint32_t variablesBegin;
+                uint32_t variablesCount;
+            };
+
+            //throws std::out_of_range
+            const Node& GetNode(size_t node) const;
+
+        private:
+            std::vector<Node> m_Nodes;
+            std::string m_Paths;
+            std::vector<size_t> m_VariableIndices;
+        };
+
+    public:
+        //a variable that a Schema reads: its path, C++ type and the value used if the variables don't have it. Strings are declared as std::string_view, so the field can be constexpr.
+        //Declared constexpr, e.g. static constexpr ConfigFile::SchemaField<int> SHADOWS_RESOLUTION{ "render/shadows/resolution", 2048 };
+        template<typename T>
+        struct SchemaField
+        {
+            static_assert(TypeToDataType<T>() != DataType::Invalid && !std::is_same_v<T, std::string>, "The type has no DataType");
+
+            static constexpr DataType DATA_TYPE = TypeToDataType<T>();
+
+            //what the schema keeps and Schema::Get returns. Strings are owned by the schema, so they don't point into the variables
+            using ValueType = std::conditional_t<std::is_same_v<T, std::string_view>, std::string, T>;
+
+            std::string_view path;
+            T defaultValue;
+        };
+        //a field that cannot be read from the variables, so the schema has its default value
+        struct SchemaMismatch
+        {
+            enum class Reason : uint8_t
+            {
+                Missing = 0,
+                //the variable has another DataType or is an array
+                WrongType,
+                //the value fails to convert
+                InvalidValue
+            };
+
+            std::string_view path;
+            DataType expectedType;
+            Reason reason;
+        };
+        //the values of FIELDS, which are SchemaFields. Bind looks the paths up and checks the types, after that Get<FIELD> is a tuple access resolved at compile time.
+        //A schema bound to a ConfigFile reads it again when its variables change. A field that is not a part of the schema doesn't compile
+        template<const auto&... FIELDS>
+        struct Schema;
+
+    public:
+        //with useCompiledCache the variables are loaded from the CompiledCache if it is fresh, otherwise the file is parsed and the cache is rewritten.
+        //parsingThreadsCount threads parse the top level scopes of a big file at once, 0 means std::thread::hardware_concurrency(). The variables are the same with any amount
+        ConfigFile(std::filesystem::path configFilePath, bool createOrOpen = true, StorageMode storageMode = StorageMode::Copy, bool useCompiledCache = false, uint32_t parsingThreadsCount = 1);
         ~ConfigFile() = default;
 
-        ConfigFile(const ConfigFile& other) = default;
+        //a copy of a ConfigFile with concurrent reads has its own SnapshotPublisher
+        ConfigFile(const ConfigFile& other);
         ConfigFile(ConfigFile&& other) noexcept = default;
-        ConfigFile& operator=(const ConfigFile& other) = default;
+        ConfigFile& operator=(const ConfigFile& other);
         ConfigFile& operator=(ConfigFile&& other) noexcept = default;
 
         bool operator==(const ConfigFile& other) const;
 
-        void Reopen();
+        //parses again only the top level scopes that have changed since the last Reopen, the variables of the other ones are kept as they are.
+        //Returns the paths of the added, changed and deleted variables. With the CompiledCache or after a Transaction the whole file is loaded
+        std::vector<std::string> Reopen();
 
+        //both write the file immediately, use BeginTransaction for many changes
         void WriteVariable(Variable variable);
 
         void DeleteVariable(const std::string_view& path);
+        //deletes every scope of the namespace from the file, with the namespaces in it. Its variables are found by the NamespaceTree, not by comparing paths.
+        //Throws std::invalid_argument if the file doesn't have the namespace
+        void DeleteNamespace(const std::string_view& namespacePath);
+
+        //the ConfigFile must outlive the transaction
+        Transaction BeginTransaction();
 
         static std::vector<Variable> ExtractVariablesFromString(const std::string_view& configSource);
         static std::vector<Variable> ExtractVariablesFromFile(const std::filesystem::path& configFilePath);
@@ -438,19 +939,98 @@ namespace GuelderResourcesManager
         /// @return Gets full raw source of the config file
         std::string GetConfigFileSource() const;
         const std::filesystem::path& GetPath() const;
+        StorageMode GetStorageMode() const noexcept;
+        //SaveMode::Atomic by default
+        SaveMode GetSaveMode() const noexcept;
+        void SetSaveMode(SaveMode saveMode) noexcept;
+        bool IsCompiledCacheEnabled() const noexcept;
+        //takes effect on the next Reopen
+        void SetCompiledCacheEnabled(bool isEnabled) noexcept;
+        uint32_t GetParsingThreadsCount() const noexcept;
+        //takes effect on the next Reopen, 0 means std::thread::hardware_concurrency()
+        void SetParsingThreadsCount(uint32_t parsingThreadsCount) noexcept;
+
+        //After this, Reopen and Transaction::Commit publish a snapshot of the variables, which other threads read with GetSnapshot or a SnapshotReader without locking.
+        //The changes and the methods returning references must still be used from one thread at a time
+        void EnableConcurrentReads();
+        bool AreConcurrentReadsEnabled() const noexcept;
+        //throws std::logic_error if the concurrent reads are disabled
+        std::shared_ptr<const Snapshot> GetSnapshot() const;
+        //throws std::logic_error if the concurrent reads are disabled. It stays valid when the ConfigFile is moved
+        const SnapshotPublisher& GetSnapshotPublisher() const;
 
         /// @param variablePath The namespace path to the variable. Syntax: namespace/namespace/variablePath or variablePath if there are no any namespaces.
         /// @returns The variable that is saved in m_Variables.
         const Variable& GetVariable(const std::string_view& variablePath) const;
+        //returns nullptr if nothing is found
+        const Variable* FindVariable(const std::string_view& variablePath) const noexcept;
         const std::vector<Variable>& GetVariables() const;
+        //the namespaces of GetVariables, rebuilt with them
+        const NamespaceTree& GetNamespaceTree() const noexcept;
+        //every variable in the namespace or in the namespaces under it, namespace by namespace in the order of the NamespaceTree. Empty if there are none
+        std::vector<const Variable*> GetVariablesUnder(const std::string_view& namespacePath) const;
+        //the same variables, passed to callback one by one without collecting them: O(log N) to find the namespace, then O(k).
+        //If callback returns bool, false stops the iteration. The variables must not be changed meanwhile
+        template<typename Callback>
+            requires std::invocable<Callback&, const Variable&>
+        void ForEachUnder(const std::string_view& namespacePath, Callback&& callback) const;
 
         //may throw an error
         void Format(const Parser::StringRange& range = {}) const;
 
+    private:
+        //a part of the source from Parser::SplitTopLevelScopes. Its variables follow the ones of the previous segment in m_Variables
+        struct SourceSegment
+        {
+            uint64_t hash;
+            size_t size;
+            size_t variablesCount;
+            //whether it is parsed the same on its own as a part of the whole source. Otherwise the rest of the source is merged into it and Reopen never keeps it
+            bool isSelfContained;
+        };
+
+        //parses the whole source by segments, StorageMode::View variables keep a copy of it
+        static std::vector<Variable> ParseSegmentedVariables(const std::string_view& source, StorageMode storageMode, std::vector<SourceSegment>& segments, uint32_t threadsCount);
+        //parses source by the ranges, appending to variables and segments. If viewStorage is set, source must be owned by it.
+        //With more than one thread, the ranges of a big source are parsed on up to threadsCount threads, the calling one included
+        static void ParseSegments(std::vector<Variable>& variables, std::vector<SourceSegment>& segments, const std::string_view& source, const std::vector<Parser::StringRange>& ranges, const std::shared_ptr<ViewStorage>& viewStorage, uint32_t threadsCount);
+        //the paths which are not in both or are different
+        static std::vector<std::string> ReceiveChangedPaths(const std::vector<const Variable*>& oldVariables, const std::vector<const Variable*>& newVariables);
+
+        //parses the file according to storageMode
+        static std::vector<Variable> LoadVariables(const std::filesystem::path& configFilePath, StorageMode storageMode, bool useCompiledCache = false);
+        //source is kept alive by the View variables
+        static std::vector<Variable> ParseVariables(std::string source, StorageMode storageMode);
+        void Load();
+        //returns the changed paths
+        std::vector<std::string> ReplaceVariables(std::vector<Variable> variables, std::optional<std::vector<SourceSegment>> sourceSegments);
+
+        //returns EMPTY_VARIABLE_INDEX if nothing is found
+        size_t FindVariableIndex(const std::string_view& variablePath) const noexcept;
+        //rebuilds m_VariablesIndex and m_NamespaceTree from scratch and changes m_VariablesVersion
+        void UpdateVariablesIndices();
+        //after the values change while the paths stay, e.g. after Reopen replaces the variables in place
+        void UpdateVariablesVersion() noexcept;
+        //does nothing if the concurrent reads are disabled
+        void PublishSnapshot();
+
     private:
         std::filesystem::path m_Path;
+        StorageMode m_StorageMode;
+        SaveMode m_SaveMode;
+        bool m_UseCompiledCache;
+        uint32_t m_ParsingThreadsCount;
 
         std::vector<Variable> m_Variables;
+        VariablesIndex m_VariablesIndex;
+        NamespaceTree m_NamespaceTree;
+        //changes whenever m_Variables do, a Schema reads them again then
+        uint64_t m_VariablesVersion;
+        //std::nullopt if m_Variables are not parsed by segments, e.g. loaded from the CompiledCache or changed by a Transaction
+        std::optional<std::vector<SourceSegment>> m_SourceSegments;
+
+        //nullptr if the concurrent reads are disabled. On the heap, so the readers keep it when the ConfigFile is moved
+        std::unique_ptr<SnapshotPublisher> m_SnapshotPublisher;
     };
 
     struct Variable
@@ -461,6 +1041,9 @@ namespace GuelderResourcesManager
         using Array = std::vector<T>;
     public:
         Variable(std::string variablePath, std::string value = "", DataType type = DataType::Invalid, bool isArray = false);
+        //the variable doesn't own the path and the value, they must point into storage, which is kept alive by the variable.
+        //If storageMemory is set, it must be owned by storage too, and the items of an array are cached in it instead of a separate allocation
+        Variable(std::string_view variablePath, std::string_view value, DataType type, bool isArray, std::shared_ptr<const void> storage, std::pmr::memory_resource* storageMemory = nullptr);
         ~Variable() = default;
 
         Variable(const Variable& other) = default;
@@ -475,188 +1058,392 @@ namespace GuelderResourcesManager
         template<typename T>
         T GetValue() const
         {
-            throw std::exception{ "The type is invalid" };
+            throw std::invalid_argument{ "The type is invalid" };
         }
 
+        //if Numeral is exactly the variable's type, the value is taken from the cache
         template<IsNumber Numeral>
+            requires (!std::same_as<Numeral, bool>)
         Numeral GetValue() const
         {
             if(!IsNumeral())
                 throw std::invalid_argument("The variable's type is not numeral.");
 
-            return StringToNumber<Numeral>(m_Value);
+            if constexpr(!std::is_same_v<Numeral, long double>)
+                if(const Numeral* cachedValue = std::get_if<Numeral>(&m_CachedValue))
+                    return *cachedValue;
+
+            return StringToNumber<Numeral>(GetRawValue());
         }
-        template<>
+        template<typename T>
+            requires std::same_as<T, bool>
         bool GetValue() const
         {
             if(m_Type != DataType::Bool)
                 throw std::invalid_argument{ "Wrong variable type" };
 
-            return StringToBool(m_Value);
+            if(const bool* cachedValue = std::get_if<bool>(&m_CachedValue))
+                return *cachedValue;
+
+            return StringToBool(GetRawValue());
         }
-        template<>
+        //only for variables that own their value, use GetValue<std::string_view> otherwise
+        template<typename T>
+            requires std::same_as<T, const std::string&>
         const std::string& GetValue() const
         {
             if(m_Type != DataType::String)
                 throw std::invalid_argument{ "Wrong variable type" };
+            if(IsView())
+                throw std::invalid_argument{ "The variable doesn't own its value" };
 
-            return m_Value;
+            return static_cast<const OwnedStrings*>(m_Storage.get())->value;
         }
-        template<>
+        template<typename T>
+            requires std::same_as<T, std::string>
         std::string GetValue() const
         {
             if(m_Type != DataType::String)
                 throw std::invalid_argument{ "Wrong variable type" };
 
-            return m_Value;
+            return std::string{ GetRawValue() };
+        }
+        //points into the variable, so it is valid as long as the variable is
+        template<typename T>
+            requires std::same_as<T, std::string_view>
+        std::string_view GetValue() const
+        {
+            if(m_Type != DataType::String)
+                throw std::invalid_argument{ "Wrong variable type" };
+
+            return GetRawValue();
         }
 
         template<typename T>
         Array<T> GetArrayValue() const
         {
-            throw std::exception{ "The type is invalid" };
+            throw std::invalid_argument{ "The type is invalid" };
         }
-        //yeah the code is dogshit, but I'm too lazy to incapsulate
         template<IsNumber Numeral>
         Array<Numeral> GetArrayValue() const
         {
-            using index = ConfigFile::Parser::index;
-
             if((!IsNumeral() || m_Type == DataType::Bool) && !m_IsArray)
                 throw std::invalid_argument{ "Wrong variable type" };
 
-            Array<Numeral> result;
-
-            index valueBegin = 0;
-            bool valueScopeClosed = true;
-            //parsing
-            if(m_Type == DataType::Bool)
-                for(index i = 0; i < m_Value.size(); i++)
-                {
-                    char currentChar = m_Value[i];
+            if(!m_ArrayCache)
+                return {};
 
-                    if(currentChar == ConfigFile::Parser::VARIABLE_VALUE_SCOPE)
-                    {
-                        size_t specialCharSignCount = 0;
-                        for(index j = i - 1; j > 0; j--)
-                        {
-                            char _currentChar = m_Value[j];
-                            if(_currentChar == ConfigFile::Parser::SPECIAL_CHAR_SIGN)
-                                specialCharSignCount++;
-                            else
-                                break;
-                        }
+            //the items are already converted
+            if(TypeToDataType<Numeral>() == m_Type && m_ArrayCache->items)
+            {
+                const std::span<const Numeral> items = GetArraySpan<Numeral>();
 
-                        if(specialCharSignCount % 2 == 0)
-                            valueScopeClosed = !valueScopeClosed;
+                return { items.begin(), items.end() };
+            }
 
-                        if(!valueScopeClosed)
-                            valueBegin = i;
-                        else
-                            result.push_back(StringToBool({ m_Value.cbegin() + valueBegin + 1, m_Value.cbegin() + i }));
-                    }
-                }
-            else
-                for(index i = 0; i < m_Value.size(); i++)
-                {
-                    char currentChar = m_Value[i];
+            const std::string_view rawValue = GetRawValue();
 
-                    if(currentChar == ConfigFile::Parser::VARIABLE_VALUE_SCOPE)
-                    {
-                        size_t specialCharSignCount = 0;
-                        for(index j = i - 1; j > 0; j--)
-                        {
-                            char _currentChar = m_Value[j];
-                            if(_currentChar == ConfigFile::Parser::SPECIAL_CHAR_SIGN)
-                                specialCharSignCount++;
-                            else
-                                break;
-                        }
+            Array<Numeral> result;
+            result.reserve(m_ArrayCache->itemRanges.size());
 
-                        if(specialCharSignCount % 2 == 0)
-                            valueScopeClosed = !valueScopeClosed;
+            for(const ArrayItemRange& itemRange : m_ArrayCache->itemRanges)
+            {
+                const std::string_view item = rawValue.substr(itemRange.begin, itemRange.size);
 
-                        if(!valueScopeClosed)
-                            valueBegin = i;
-                        else
-                            result.push_back(StringToNumber<Numeral>({ m_Value.cbegin() + valueBegin + 1, m_Value.cbegin() + i }));
-                    }
-                }
+                if(m_Type == DataType::Bool)
+                    result.push_back(StringToBool(item));
+                else
+                    result.push_back(StringToNumber<Numeral>(item));
+            }
 
             return result;
         }
-        template<>
+        template<typename T>
+            requires std::same_as<T, std::string>
         Array<std::string> GetArrayValue() const
         {
-            using index = ConfigFile::Parser::index;
-
             if(m_Type != DataType::String && !m_IsArray)
                 throw std::invalid_argument{ "Wrong variable type" };
 
+            if(!m_ArrayCache)
+                return {};
+
+            const std::string_view rawValue = GetRawValue();
+
             Array<std::string> result;
+            result.reserve(m_ArrayCache->itemRanges.size());
 
-            index valueBegin = 0;
-            bool valueScopeClosed = true;
-            //parsing
-            for(index i = 0; i < m_Value.size(); i++)
-            {
-                char currentChar = m_Value[i];
+            for(const ArrayItemRange& itemRange : m_ArrayCache->itemRanges)
+                result.push_back(ConfigFile::Parser::RemoveSpecialChars(rawValue.substr(itemRange.begin, itemRange.size)));
 
-                if(currentChar == ConfigFile::Parser::VARIABLE_VALUE_SCOPE)
-                {
-                    size_t specialCharSignCount = 0;
-                    for(index j = i - 1; j > 0; j--)
-                    {
-                        char _currentChar = m_Value[j];
-                        if(_currentChar == ConfigFile::Parser::SPECIAL_CHAR_SIGN)
-                            specialCharSignCount++;
-                        else
-                            break;
-                    }
+            return result;
+        }
 
-                    if(specialCharSignCount % 2 == 0)
-                    {
-                        valueScopeClosed = !valueScopeClosed;
+        //doesn't allocate: the items are converted once, when the variable is created. T must be exactly the C++ type of the variable's DataType
+        template<IsNumber T>
+        std::span<const T> GetArraySpan() const
+        {
+            if(!m_IsArray || TypeToDataType<T>() != m_Type)
+                throw std::invalid_argument{ "Wrong variable type" };
 
-                        if(!valueScopeClosed)
-                            valueBegin = i;
-                        else
-                        {
-                            std::string value{ m_Value.cbegin() + valueBegin + 1, m_Value.cbegin() + i };
+            if(!m_ArrayCache)
+                return {};
 
-                            for(char specialChar : ConfigFile::Parser::SPECIAL_CHARS)
-                                for(index j = 0; j < value.size(); j++)
-                                    if(j > 0 && value[j] == specialChar && value[j - 1] == ConfigFile::Parser::SPECIAL_CHAR_SIGN)
-                                        value.erase(j - 1, 1);
+            if(!m_ArrayCache->items)
+            {
+                //some item failed to convert, so let it throw the usual error
+                for(const ArrayItemRange& itemRange : m_ArrayCache->itemRanges)
+                {
+                    const std::string_view item = GetRawValue().substr(itemRange.begin, itemRange.size);
 
-                            result.push_back(std::move(value));
-                        }
-                    }
+                    if constexpr(std::is_same_v<T, bool>)
+                        StringToBool(item);
+                    else
+                        StringToNumber<T>(item);
                 }
+
+                return {};
             }
 
-            return result;
+            return { static_cast<const T*>(m_ArrayCache->items), m_ArrayCache->itemRanges.size() };
         }
 
         [[nodiscard]]
         bool IsNumeral() const;
 
-        const std::string& GetRawValue() const;
+        std::string_view GetRawValue() const;
         DataType GetType() const noexcept;
         std::string_view GetName() const;
-        const std::string& GetPath() const;
+        std::string_view GetPath() const;
         bool IsArray() const;
+        //whether the path and the value point into a shared storage, see ConfigFile::StorageMode::View
+        bool IsView() const noexcept;
 
     private:
-        std::string m_Path;
+        friend struct ConfigFile::Parser;
+        friend struct ConfigFile::CompiledCache;
+
+        //the alternative is always the C++ type of m_Type, e.g. float for DataType::Float. long double is not cached, so the variant takes 16 bytes instead of 32
+        using CachedValue = std::variant<std::monostate, int, unsigned int, long, unsigned long, long long, unsigned long long, short, unsigned short, char, unsigned char, float, double, bool>;
+
+        //what a variable that is not a view owns, shared between its copies. The chars of the path follow it in the same allocation
+        struct OwnedStrings
+        {
+            std::string_view path;
+            std::string value;
+        };
+
+        //the path is pathPrefix followed by name
+        static std::shared_ptr<const OwnedStrings> ReceiveOwnedStrings(const std::string_view& pathPrefix, const std::string_view& name, std::string value);
+
+        //returns std::monostate for arrays, strings and values that fail to convert, so GetValue goes the slow way and throws as before
+        static CachedValue ReceiveCachedValue(DataType type, const std::string_view& value, bool isArray) noexcept;
+
+        //an item inside the raw value, without VARIABLE_VALUE_SCOPEs
+        struct ArrayItemRange
+        {
+            uint32_t begin;
+            uint32_t size;
+        };
+        //the item ranges and the items follow it in the same block
+        struct ArrayCache
+        {
+            std::span<const ArrayItemRange> itemRanges;
+            //T[] where T is the C++ type of the variable's DataType. nullptr for strings and if any item fails to convert
+            const void* items;
+        };
+
+        //nullptr if the variable is not an array. The cache is allocated from storageMemory if it is set, then it keeps storage alive instead of owning the block
+        static std::shared_ptr<const ArrayCache> ReceiveArrayCache(DataType type, const std::string_view& value, bool isArray, const std::shared_ptr<const void>& storage = nullptr, std::pmr::memory_resource* storageMemory = nullptr);
+
+        Variable(std::shared_ptr<const OwnedStrings> ownedStrings, DataType type, bool isArray);
+        //for ConfigFile::CompiledCache, the value is already parsed. Without storage the path and the value are copied
+        Variable(std::string_view variablePath, std::string_view value, DataType type, bool isArray, CachedValue cachedValue, std::shared_ptr<const void> storage);
+
+    private:
+        //the value is parsed once in the constructor, variables are not changed after that
+        CachedValue m_CachedValue;
+        //shared between copies
+        std::shared_ptr<const ArrayCache> m_ArrayCache;
+        //point into m_Storage
+        std::string_view m_Path;
+        std::string_view m_Value;
+        //the OwnedStrings of the variable or the storage of a view. Shared between copies, so copying a variable doesn't allocate
+        std::shared_ptr<const void> m_Storage;
         DataType m_Type;
-        std::string m_Value;
         bool m_IsArray : 1;
+        bool m_IsView : 1;
+    };
+
+    template<const auto&... FIELDS>
+    struct ConfigFile::Schema
+    {
+    public:
+        //every field has its default value
+        Schema()
+            : m_ConfigFile(nullptr), m_VariablesVersion(0), m_Values{ FIELDS.defaultValue... } {
+        }
+        //VariablesSource is a ConfigFile or a Snapshot
+        template<typename VariablesSource>
+        explicit Schema(const VariablesSource& variablesSource)
+            : Schema()
+        {
+            Bind(variablesSource);
+        }
+
+        //a ConfigFile is read again by Get and GetMismatches after its variables change, e.g. after ConfigFile::Reopen or a Transaction, so it must outlive the schema
+        //and not be moved. A Snapshot never changes, so it is read once and may be destroyed after Bind.
+        //Missing and mistyped fields get their default values and are reported by GetMismatches
+        template<typename VariablesSource>
+        void Bind(const VariablesSource& variablesSource)
+        {
+            if constexpr(std::is_same_v<VariablesSource, ConfigFile>)
+            {
+                m_ConfigFile = &variablesSource;
+                m_VariablesVersion = variablesSource.m_VariablesVersion;
+            }
+            else
+                m_ConfigFile = nullptr;
+
+            Read(variablesSource);
+        }
+
+        //the reference is valid until the variables of the bound ConfigFile change
+        template<const auto& FIELD>
+        const auto& Get() const
+        {
+            constexpr size_t FIELD_INDEX = ReceiveFieldIndex<FIELD>();
+
+            static_assert(FIELD_INDEX < sizeof...(FIELDS), "The field is not a part of the schema");
+
+            Update();
+
+            return std::get<FIELD_INDEX>(m_Values);
+        }
+
+        //the fields that could not be read from the variables, in the order of FIELDS
+        const std::vector<SchemaMismatch>& GetMismatches() const
+        {
+            Update();
+
+            return m_Mismatches;
+        }
+
+    private:
+        //fields are told apart by their addresses, so two fields with the same path and type are still different
+        template<const auto& FIELD>
+        static consteval size_t ReceiveFieldIndex()
+        {
+            constexpr std::array<const void*, sizeof...(FIELDS)> FIELDS_ADDRESSES{ &FIELDS... };
+
+            for(size_t i = 0; i < FIELDS_ADDRESSES.size(); i++)
+                if(FIELDS_ADDRESSES[i] == &FIELD)
+                    return i;
+
+            return FIELDS_ADDRESSES.size();
+        }
+        static consteval bool ArePathsUnique()
+        {
+            constexpr std::array<std::string_view, sizeof...(FIELDS)> PATHS{ FIELDS.path... };
+
+            for(size_t i = 0; i < PATHS.size(); i++)
+                for(size_t j = i + 1; j < PATHS.size(); j++)
+                    if(PATHS[i] == PATHS[j])
+                        return false;
+
+            return true;
+        }
+
+        static_assert(ArePathsUnique(), "Two fields of the schema have the same path");
+        static_assert((!std::is_same_v<typename std::remove_cvref_t<decltype(FIELDS)>::ValueType, std::string_view> && ...), "A string field would point into the variables");
+
+        //reads the bound ConfigFile again if its variables have changed
+        void Update() const
+        {
+            if(m_ConfigFile && m_ConfigFile->m_VariablesVersion != m_VariablesVersion)
+            {
+                m_VariablesVersion = m_ConfigFile->m_VariablesVersion;
+
+                Read(*m_ConfigFile);
+            }
+        }
+        template<typename VariablesSource>
+        void Read(const VariablesSource& variablesSource) const
+        {
+            m_Mismatches.clear();
+
+            [&]<size_t... INDICES>(std::index_sequence<INDICES...>)
+                {
+                    (ReadField<INDICES>(variablesSource), ...);
+                }(std::make_index_sequence<sizeof...(FIELDS)>{});
+        }
+        template<size_t FIELD_INDEX, typename VariablesSource>
+        void ReadField(const VariablesSource& variablesSource) const
+        {
+            const auto& field = std::get<FIELD_INDEX>(std::tie(FIELDS...));
+            auto& value = std::get<FIELD_INDEX>(m_Values);
+
+            using Field = std::remove_cvref_t<decltype(field)>;
+
+            value = field.defaultValue;
+
+            const auto addMismatch = [this, &field](SchemaMismatch::Reason reason) { m_Mismatches.push_back({ field.path, Field::DATA_TYPE, reason }); };
+
+            const Variable* variable = variablesSource.FindVariable(field.path);
+
+            if(!variable)
+                addMismatch(SchemaMismatch::Reason::Missing);
+            else if(variable->GetType() != Field::DATA_TYPE || variable->IsArray())
+                addMismatch(SchemaMismatch::Reason::WrongType);
+            else
+            {
+                try
+                {
+                    value = variable->template GetValue<decltype(field.defaultValue)>();
+                }
+                catch(const std::invalid_argument&)
+                {
+                    addMismatch(SchemaMismatch::Reason::InvalidValue);
+                }
+            }
+        }
+
+    private:
+        //nullptr if the schema is not bound or is bound to a Snapshot
+        const ConfigFile* m_ConfigFile;
+        //of the variables m_Values are read from
+        mutable uint64_t m_VariablesVersion;
+
+        //a cache of the variables of m_ConfigFile, so Get is const
+        mutable std::tuple<typename std::remove_cvref_t<decltype(FIELDS)>::ValueType...> m_Values;
+        mutable std::vector<SchemaMismatch> m_Mismatches;
     };
+
+    template<typename Callback>
+        requires std::invocable<Callback&, const Variable&>
+    void ConfigFile::ForEachUnder(const std::string_view& namespacePath, Callback&& callback) const
+    {
+        const size_t node = m_NamespaceTree.Find(namespacePath);
+
+        if(node == NamespaceTree::EMPTY_NODE)
+            return;
+
+        for(const size_t variableIndex : m_NamespaceTree.GetVariableIndicesUnder(node))
+        {
+            if constexpr(std::is_same_v<std::invoke_result_t<Callback&, const Variable&>, bool>)
+            {
+                if(!std::invoke(callback, m_Variables[variableIndex]))
+                    return;
+            }
+            else
+                std::invoke(callback, m_Variables[variableIndex]);
+        }
+    }
 }
 
 namespace GuelderResourcesManager
 {
+#ifdef WIN32
     template<typename Char>
     constexpr auto GetPOpen()
     {
@@ -673,6 +1460,7 @@ namespace GuelderResourcesManager
         else
             return fgetws;
     }
+#endif
 
     class ResourcesManager
     {
@@ -685,6 +1473,7 @@ namespace GuelderResourcesManager
         ResourcesManager& operator=(const ResourcesManager& other) = default;
         ResourcesManager& operator=(ResourcesManager&& other) noexcept = default;
 
+#ifdef WIN32
         //if outputs == std::numeric_limits<uint32_t>::max() then all outputs will be received
         //this one probably can't be stopped, so I'm making a windows version of this one
         template<typename InChar = char, typename OutChar = InChar, uint32_t bufferSize = 128, String String = std::basic_string<InChar>>
@@ -731,7 +1520,6 @@ namespace GuelderResourcesManager
             return result;
         }
 
-#ifdef WIN32
         struct Handle;
         struct ProcessInfo;
         //if outputs == std::numeric_limits<uint32_t>::max() then all outputs will be received
@@ -939,14 +1727,133 @@ namespace GuelderResourcesManager
         private:
             PROCESS_INFORMATION m_ProcessInfo;
         };
+#else
+        struct CommandResult
+        {
+            std::vector<std::string> outputs;
+            //the exit code, or 128 + the signal number if the process was killed by a signal
+            int exitStatus;
+        };
+
+        //if outputs == std::numeric_limits<uint32_t>::max() then all outputs will be received, otherwise the process is killed after that many lines
+        //the command is split into arguments by whitespaces, quotes group arguments. Without useShell no shell is involved, so no expansions are done
+        //returns std::unexpected if the process cannot be started
+        static std::expected<CommandResult, std::string> ExecuteCommand(const std::string_view& command, uint32_t outputs = std::numeric_limits<uint32_t>::max(), bool useShell = false);
+        //arguments[0] is searched in PATH
+        static std::expected<CommandResult, std::string> ExecuteCommand(const std::vector<std::string>& arguments, uint32_t outputs = std::numeric_limits<uint32_t>::max());
+#endif
+
+        enum class OutputMode : uint8_t
+        {
+            //without '\n', the last line may be incomplete
+            Lines = 0,
+            //as read, the memory used doesn't depend on the output
+            Chunks
+        };
+        //the output is valid only during the call. Return false to stop the process
+        using OutputCallback = std::function<bool(std::string_view output)>;
+
+        //callback is called on the calling thread as soon as the output arrives. While it runs nothing is read, so the process blocks once the pipe is full
+        //the process is killed if callback returns false or stopToken is triggered (it may be triggered from any thread)
+        //returns the exit status, std::unexpected if the process cannot be started. On Windows the command line is passed to CreateProcess as it is
+        static std::expected<int, std::string> ExecuteCommandStreaming(const std::string_view& command, const OutputCallback& callback, OutputMode outputMode = OutputMode::Lines, bool useShell = false, std::stop_token stopToken = {});
+#ifndef WIN32
+        //arguments[0] is searched in PATH
+        static std::expected<int, std::string> ExecuteCommandStreaming(const std::vector<std::string>& arguments, const OutputCallback& callback, OutputMode outputMode = OutputMode::Lines, std::stop_token stopToken = {});
+
+        //runs the submitted commands at most maxProcesses at once. One background thread starts them and reads the outputs of all of them with poll
+        class CommandExecutor
+        {
+        public:
+            //called on the executor's thread, so it should be short. If it throws, the executor fails: the other commands are killed or not started,
+            //they and the ones submitted later complete with an error
+            using CompletionCallback = std::function<void(std::expected<CommandResult, std::string>&& result)>;
+
+            //0 means std::thread::hardware_concurrency()
+            CommandExecutor(uint32_t maxProcesses = 0);
+            //waits for all the submitted commands
+            ~CommandExecutor();
+
+            CommandExecutor(const CommandExecutor& other) = delete;
+            CommandExecutor& operator=(const CommandExecutor& other) = delete;
+
+            //same as ExecuteCommand, but returns immediately
+            std::future<std::expected<CommandResult, std::string>> Submit(const std::string_view& command, uint32_t outputs = std::numeric_limits<uint32_t>::max(), bool useShell = false);
+            std::future<std::expected<CommandResult, std::string>> Submit(std::vector<std::string> arguments, uint32_t outputs = std::numeric_limits<uint32_t>::max());
+            void Submit(std::vector<std::string> arguments, CompletionCallback callback, uint32_t outputs = std::numeric_limits<uint32_t>::max());
+
+            //blocks until all the submitted commands are finished
+            void Wait();
+
+            uint32_t GetMaxProcesses() const noexcept;
+
+        private:
+            struct Task
+            {
+                std::vector<std::string> arguments;
+                uint32_t outputs;
+                CompletionCallback callback;
+            };
+
+            void Run(std::stop_token stopToken);
+            //takes tasks from the queue while there are less than m_MaxProcesses processes
+            std::vector<Task> ReceiveTasksToStart(size_t runningProcessesCount);
+            //rethrows what the callback throws
+            void Complete(const CompletionCallback& callback, std::expected<CommandResult, std::string>&& result);
+            void WakeUp() const noexcept;
+
+        private:
+            uint32_t m_MaxProcesses;
+
+            std::mutex m_Mutex;
+            std::condition_variable m_IdleCondition;
+            std::deque<Task> m_Tasks;
+            //queued and running
+            size_t m_UnfinishedTasksCount;
+            //errno value the executor failed with, 0 while it works
+            int m_Error;
+
+            //written to wake up the poll of m_Thread
+            int m_WakeUpFileDescriptors[2];
+            std::jthread m_Thread;
+        };
 #endif
 
+        //read-only view of the whole file. Regular files are mapped into memory, pipes and special files are read into an owned buffer.
+        //On Windows a mapped file cannot be replaced until it is unmapped
+        class MappedFile
+        {
+        public:
+            //throws std::filesystem::filesystem_error if the file cannot be opened or read
+            MappedFile(const std::filesystem::path& filePath);
+            ~MappedFile();
+
+            MappedFile(const MappedFile& other) = delete;
+            MappedFile(MappedFile&& other) noexcept;
+            MappedFile& operator=(const MappedFile& other) = delete;
+            MappedFile& operator=(MappedFile&& other) noexcept;
+
+            //valid as long as the MappedFile is alive
+            std::string_view GetSource() const noexcept;
+            bool IsMapped() const noexcept;
+
+        private:
+            void Unmap() noexcept;
+
+        private:
+            const char* m_MappedData;
+            size_t m_MappedSize;
+            //used when the file cannot be mapped
+            std::string m_Buffer;
+        };
+
         static std::string ReceiveFileSource(const std::filesystem::path& filePath);
 
         static void AppendToFile(const std::filesystem::path& filePath, const std::string_view& append);
-        static void WriteToFile(const std::filesystem::path& filePath, const std::string_view& content);
+        //throws std::filesystem::filesystem_error or std::ios::failure. If filePath is a symlink, the file it points to is replaced
+        static void WriteToFile(const std::filesystem::path& filePath, const std::string_view& content, SaveMode saveMode = SaveMode::Atomic);
         //almost useless, use better first Rea
-        static void WriteToFile(const std::filesystem::path& filePath, ConfigFile::Parser::index index, const std::string_view& content);
+        static void WriteToFile(const std::filesystem::path& filePath, ConfigFile::Parser::index index, const std::string_view& content, SaveMode saveMode = SaveMode::Atomic);
 
         std::filesystem::path GetFullPathToRelativeFile(const std::filesystem::path& relativePath) const;
 
@@ -6,19 +6,328 @@
 #include <format>
 #include <string>
 #include <string_view>
-
-#include "../../GuelderConsoleLog/include/GuelderConsoleLog.hpp"
+#include <cstring>
+#include <memory_resource>
+#include <unordered_set>
+#include <algorithm>
+#include <bit>
+#include <atomic>
+#include <condition_variable>
+
+#ifndef WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <csignal>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/syscall.h>
+#endif
+
+//SSE2 is always there on x86-64, AVX2 is checked at runtime
+#if defined(__x86_64__) || defined(_M_X64)
+#define GE_X86_64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+//MSVC compiles the intrinsics of any instruction set without flags
+#define GE_TARGET_AVX2
+#else
+#define GE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
 
 //Variable
 namespace GuelderResourcesManager
 {
+    namespace
+    {
+        template<IsNumber Numeral, typename Variant>
+        Variant ParseCachedNumber(const std::string_view& value) noexcept
+        {
+            Numeral result = 0;
+
+            //the same check as in StringToNumber
+            if(const auto [wrongChar, errorCode] = std::from_chars(value.data(), value.data() + value.size(), result); static_cast<int>(errorCode) != 0)
+                return {};
+
+            return result;
+        }
+
+        //false if any item fails to convert
+        template<typename T>
+        bool ConvertArrayItems(const std::string_view& value, const auto& itemRanges, void* items) noexcept
+        {
+            T* result = static_cast<T*>(items);
+
+            for(size_t i = 0; i < itemRanges.size(); i++)
+            {
+                const std::string_view item = value.substr(itemRanges[i].begin, itemRanges[i].size);
+
+                T* convertedItem = new(result + i) T{};
+
+                if constexpr(std::is_same_v<T, bool>)
+                {
+                    if(item == "true" || item == "1")
+                        *convertedItem = true;
+                    else if(item == "false" || item == "0")
+                        *convertedItem = false;
+                    else
+                        return false;
+                }
+                else if(static_cast<int>(std::from_chars(item.data(), item.data() + item.size(), *convertedItem).ec) != 0)
+                    return false;
+            }
+
+            return true;
+        }
+
+        //calls function with the beginning and the size of every item, escaped VARIABLE_VALUE_SCOPEs are skipped together with their SPECIAL_CHAR_SIGN
+        template<typename Function>
+        void ForEachArrayItem(const std::string_view& value, Function&& function)
+        {
+            size_t itemBegin = 0;
+            bool isItemOpened = false;
+            for(size_t i = 0; i < value.size(); i++)
+            {
+                const char currentChar = value[i];
+
+                if(isItemOpened && currentChar == ConfigFile::Parser::SPECIAL_CHAR_SIGN)
+                    i++;
+                else if(currentChar == ConfigFile::Parser::VARIABLE_VALUE_SCOPE)
+                {
+                    if(isItemOpened)
+                        function(itemBegin, i - itemBegin);
+                    else
+                        itemBegin = i + 1;
+
+                    isItemOpened = !isItemOpened;
+                }
+            }
+        }
+
+        //0 for the types whose items are not converted
+        size_t ReceiveArrayItemSize(DataType type) noexcept
+        {
+            switch(type)
+            {
+            case DataType::Int: return sizeof(int);
+            case DataType::UInt: return sizeof(unsigned int);
+            case DataType::Long: return sizeof(long);
+            case DataType::ULong: return sizeof(unsigned long);
+            case DataType::LongLong: return sizeof(long long);
+            case DataType::ULongLong: return sizeof(unsigned long long);
+            case DataType::Short: return sizeof(short);
+            case DataType::UShort: return sizeof(unsigned short);
+            case DataType::Char: return sizeof(char);
+            case DataType::UChar: return sizeof(unsigned char);
+            case DataType::Float: return sizeof(float);
+            case DataType::Double: return sizeof(double);
+            case DataType::LongDouble: return sizeof(long double);
+            case DataType::Bool: return sizeof(bool);
+            default: return 0;
+            }
+        }
+
+        constexpr size_t AlignUp(size_t size, size_t alignment) noexcept
+        {
+            return (size + alignment - 1) / alignment * alignment;
+        }
+
+        //allocates extraSize more bytes after what is asked for, so std::allocate_shared puts the object and its trailing chars in one allocation
+        template<typename T>
+        struct TrailingCharsAllocator
+        {
+            using value_type = T;
+
+            TrailingCharsAllocator(size_t extraSize, char** trailingChars) noexcept
+                : extraSize(extraSize), trailingChars(trailingChars) {
+            }
+            template<typename U>
+            TrailingCharsAllocator(const TrailingCharsAllocator<U>& other) noexcept
+                : extraSize(other.extraSize), trailingChars(other.trailingChars) {
+            }
+
+            T* allocate(size_t count)
+            {
+                const size_t size = count * sizeof(T);
+                char* memory = static_cast<char*>(::operator new(size + extraSize));
+
+                *trailingChars = memory + size;
+
+                return reinterpret_cast<T*>(memory);
+            }
+            void deallocate(T* memory, size_t) noexcept
+            {
+                ::operator delete(memory);
+            }
+
+            template<typename U>
+            bool operator==(const TrailingCharsAllocator<U>& other) const noexcept
+            {
+                return extraSize == other.extraSize && trailingChars == other.trailingChars;
+            }
+
+            size_t extraSize;
+            char** trailingChars;
+        };
+    }
+
     Variable::Variable(std::string variablePath, std::string value, DataType type, bool isArray)
-        : m_Path(std::move(variablePath)), m_Type(type), m_Value(std::move(value)), m_IsArray(isArray) {
+        : Variable(ReceiveOwnedStrings(variablePath, {}, std::move(value)), type, isArray) {
+    }
+    //m_ArrayCache is initialized before storage is moved into m_Storage
+    Variable::Variable(std::string_view variablePath, std::string_view value, DataType type, bool isArray, std::shared_ptr<const void> storage, std::pmr::memory_resource* storageMemory)
+        : m_CachedValue(ReceiveCachedValue(type, value, isArray)), m_ArrayCache(ReceiveArrayCache(type, value, isArray, storage, storageMemory)), m_Path(variablePath), m_Value(value), m_Storage(std::move(storage)),
+        m_Type(type), m_IsArray(isArray), m_IsView(true) {
+    }
+    Variable::Variable(std::shared_ptr<const OwnedStrings> ownedStrings, DataType type, bool isArray)
+        : m_CachedValue(ReceiveCachedValue(type, ownedStrings->value, isArray)), m_ArrayCache(ReceiveArrayCache(type, ownedStrings->value, isArray)), m_Path(ownedStrings->path), m_Value(ownedStrings->value),
+        m_Storage(std::move(ownedStrings)), m_Type(type), m_IsArray(isArray), m_IsView(false) {
+    }
+    Variable::Variable(std::string_view variablePath, std::string_view value, DataType type, bool isArray, CachedValue cachedValue, std::shared_ptr<const void> storage)
+        : m_CachedValue(std::move(cachedValue)), m_Type(type), m_IsArray(isArray), m_IsView(storage != nullptr)
+    {
+        if(!storage)
+        {
+            std::shared_ptr<const OwnedStrings> ownedStrings = ReceiveOwnedStrings(variablePath, {}, std::string{ value });
+
+            variablePath = ownedStrings->path;
+            value = ownedStrings->value;
+            storage = std::move(ownedStrings);
+        }
+
+        m_ArrayCache = ReceiveArrayCache(type, value, isArray);
+        m_Path = variablePath;
+        m_Value = value;
+        m_Storage = std::move(storage);
+    }
+
+    std::shared_ptr<const Variable::OwnedStrings> Variable::ReceiveOwnedStrings(const std::string_view& pathPrefix, const std::string_view& name, std::string value)
+    {
+        char* path = nullptr;
+
+        std::shared_ptr<OwnedStrings> ownedStrings = std::allocate_shared<OwnedStrings>(TrailingCharsAllocator<OwnedStrings>{ pathPrefix.size() + name.size(), &path }, std::string_view{}, std::move(value));
+
+        std::ranges::copy(pathPrefix, path);
+        std::ranges::copy(name, path + pathPrefix.size());
+
+        ownedStrings->path = { path, pathPrefix.size() + name.size() };
+
+        return ownedStrings;
+    }
+    std::shared_ptr<const Variable::ArrayCache> Variable::ReceiveArrayCache(DataType type, const std::string_view& value, bool isArray, const std::shared_ptr<const void>& storage, std::pmr::memory_resource* storageMemory)
+    {
+        if(!isArray)
+            return nullptr;
+
+        //the items are counted first, so the cache, the item ranges and the converted items take one block
+        size_t itemsCount = 0;
+        ForEachArrayItem(value, [&itemsCount](size_t, size_t) { itemsCount++; });
+
+        constexpr size_t ITEM_RANGES_OFFSET = AlignUp(sizeof(ArrayCache), alignof(ArrayItemRange));
+
+        const size_t itemsOffset = AlignUp(ITEM_RANGES_OFFSET + itemsCount * sizeof(ArrayItemRange), alignof(std::max_align_t));
+        const size_t blockSize = itemsOffset + itemsCount * ReceiveArrayItemSize(type);
+
+        std::shared_ptr<const void> blockOwner;
+        std::byte* block;
+
+        if(storageMemory)
+        {
+            block = static_cast<std::byte*>(storageMemory->allocate(blockSize, alignof(std::max_align_t)));
+            blockOwner = storage;
+        }
+        else
+        {
+            std::shared_ptr<std::max_align_t[]> memory = std::make_shared_for_overwrite<std::max_align_t[]>(AlignUp(blockSize, sizeof(std::max_align_t)) / sizeof(std::max_align_t));
+
+            block = reinterpret_cast<std::byte*>(memory.get());
+            blockOwner = std::move(memory);
+        }
+
+        ArrayItemRange* itemRanges = reinterpret_cast<ArrayItemRange*>(block + ITEM_RANGES_OFFSET);
+
+        size_t itemIndex = 0;
+        ForEachArrayItem(value, [itemRanges, &itemIndex](size_t itemBegin, size_t itemSize)
+            {
+                new(itemRanges + itemIndex++) ArrayItemRange{ static_cast<uint32_t>(itemBegin), static_cast<uint32_t>(itemSize) };
+            });
+
+        ArrayCache* result = new(block) ArrayCache{ { itemRanges, itemsCount }, nullptr };
+
+        void* items = block + itemsOffset;
+        bool areItemsConverted = false;
+
+        switch(type)
+        {
+        case DataType::Int: areItemsConverted = ConvertArrayItems<int>(value, result->itemRanges, items); break;
+        case DataType::UInt: areItemsConverted = ConvertArrayItems<unsigned int>(value, result->itemRanges, items); break;
+        case DataType::Long: areItemsConverted = ConvertArrayItems<long>(value, result->itemRanges, items); break;
+        case DataType::ULong: areItemsConverted = ConvertArrayItems<unsigned long>(value, result->itemRanges, items); break;
+        case DataType::LongLong: areItemsConverted = ConvertArrayItems<long long>(value, result->itemRanges, items); break;
+        case DataType::ULongLong: areItemsConverted = ConvertArrayItems<unsigned long long>(value, result->itemRanges, items); break;
+        case DataType::Short: areItemsConverted = ConvertArrayItems<short>(value, result->itemRanges, items); break;
+        case DataType::UShort: areItemsConverted = ConvertArrayItems<unsigned short>(value, result->itemRanges, items); break;
+        case DataType::Char: areItemsConverted = ConvertArrayItems<char>(value, result->itemRanges, items); break;
+        case DataType::UChar: areItemsConverted = ConvertArrayItems<unsigned char>(value, result->itemRanges, items); break;
+        case DataType::Float: areItemsConverted = ConvertArrayItems<float>(value, result->itemRanges, items); break;
+        case DataType::Double: areItemsConverted = ConvertArrayItems<double>(value, result->itemRanges, items); break;
+        case DataType::LongDouble: areItemsConverted = ConvertArrayItems<long double>(value, result->itemRanges, items); break;
+        case DataType::Bool: areItemsConverted = ConvertArrayItems<bool>(value, result->itemRanges, items); break;
+        default: break;
+        }
+
+        if(areItemsConverted)
+            result->items = items;
+
+        //the cache is destroyed with the block, it only holds pointers
+        return { std::move(blockOwner), result };
+    }
+
+    Variable::CachedValue Variable::ReceiveCachedValue(DataType type, const std::string_view& value, bool isArray) noexcept
+    {
+        if(isArray)
+            return {};
+
+        switch(type)
+        {
+        case DataType::Int: return ParseCachedNumber<int, CachedValue>(value);
+        case DataType::UInt: return ParseCachedNumber<unsigned int, CachedValue>(value);
+        case DataType::Long: return ParseCachedNumber<long, CachedValue>(value);
+        case DataType::ULong: return ParseCachedNumber<unsigned long, CachedValue>(value);
+        case DataType::LongLong: return ParseCachedNumber<long long, CachedValue>(value);
+        case DataType::ULongLong: return ParseCachedNumber<unsigned long long, CachedValue>(value);
+        case DataType::Short: return ParseCachedNumber<short, CachedValue>(value);
+        case DataType::UShort: return ParseCachedNumber<unsigned short, CachedValue>(value);
+        case DataType::Char: return ParseCachedNumber<char, CachedValue>(value);
+        case DataType::UChar: return ParseCachedNumber<unsigned char, CachedValue>(value);
+        case DataType::Float: return ParseCachedNumber<float, CachedValue>(value);
+        case DataType::Double: return ParseCachedNumber<double, CachedValue>(value);
+        case DataType::Bool:
+            if(value == "true" || value == "1")
+                return true;
+            else if(value == "false" || value == "0")
+                return false;
+            return {};
+        default:
+            return {};
+        }
     }
 
     bool Variable::operator==(const Variable& other) const
     {
-        return m_Type == other.m_Type && m_Value == other.m_Value;
+        return m_Type == other.m_Type && GetRawValue() == other.GetRawValue();
     }
 
     bool Variable::IsValidVariableChar(char ch)
@@ -49,7 +358,7 @@ namespace GuelderResourcesManager
         }
     }
 
-    const std::string& Variable::GetRawValue() const
+    std::string_view Variable::GetRawValue() const
     {
         return m_Value;
     }
@@ -59,11 +368,13 @@ namespace GuelderResourcesManager
     }
     std::string_view Variable::GetName() const
     {
-        const size_t lastSlashIndex = m_Path.find_last_of('/');
+        const std::string_view path = GetPath();
+
+        const size_t lastSlashIndex = path.find_last_of('/');
 
-        return (lastSlashIndex == std::string::npos ? m_Path : std::string_view{ m_Path.begin() + lastSlashIndex + 1, m_Path.end() });
+        return (lastSlashIndex == std::string::npos ? path : std::string_view{ path.begin() + lastSlashIndex + 1, path.end() });
     }
-    const std::string& Variable::GetPath() const
+    std::string_view Variable::GetPath() const
     {
         return m_Path;
     }
@@ -71,1582 +382,5523 @@ namespace GuelderResourcesManager
     {
         return m_IsArray;
     }
+    bool Variable::IsView() const noexcept
+    {
+        return m_IsView;
+    }
 }
 //ConfigFile
 namespace GuelderResourcesManager
 {
-    ConfigFile::ConfigFile(std::filesystem::path configFilePath, bool createOrOpen)
-        : m_Path(std::move(configFilePath))
+    namespace
     {
-        if(createOrOpen)
+        //not cryptographic, it only has to notice the changes. Eight bytes per step, so it is much faster than parsing
+        uint64_t HashSource(const std::string_view& source) noexcept
         {
-            try
-            {
-                m_Variables = ExtractVariablesFromFile(m_Path);
-            }
-            catch(...)
+            constexpr uint64_t MULTIPLIER = 0x9E3779B97F4A7C15;
+
+            uint64_t hash = source.size() * MULTIPLIER;
+            size_t i = 0;
+
+            for(; i + sizeof(uint64_t) <= source.size(); i += sizeof(uint64_t))
             {
-                ResourcesManager::WriteToFile(m_Path, "");
+                uint64_t word;
+                std::memcpy(&word, source.data() + i, sizeof(word));
+
+                hash = (hash ^ word) * MULTIPLIER;
+                hash ^= hash >> 29;
             }
-        }
-        else
-            m_Variables = ExtractVariablesFromFile(m_Path);
-    }
 
-    bool ConfigFile::operator==(const ConfigFile& other) const
-    {
-        return m_Path == other.GetPath();
-    }
+            uint64_t lastWord = 0;
+            if(i < source.size())
+                std::memcpy(&lastWord, source.data() + i, source.size() - i);
 
-    void ConfigFile::Reopen()
-    {
-        m_Variables = ExtractVariablesFromFile(m_Path);
-    }
+            hash = (hash ^ lastWord) * MULTIPLIER;
+            hash ^= hash >> 32;
 
-    void ConfigFile::WriteVariable(Variable variable)
-    {
+            return hash;
+        }
+
+        //keeps the order of the rest
+        void EraseVariables(std::vector<Variable>& variables, const std::vector<bool>& toDelete)
         {
-            const auto foundIt = std::ranges::find_if(m_Variables, [&variable](const Variable& v) { return v.GetPath() == variable.GetPath(); });
+            size_t keptCount = 0;
+
+            for(size_t i = 0; i < variables.size(); i++)
+                if(!toDelete[i])
+                {
+                    if(i != keptCount)
+                        variables[keptCount] = std::move(variables[i]);
+
+                    keptCount++;
+                }
 
-            if(foundIt != m_Variables.end())
-                throw std::invalid_argument{ "Cannot add variable with the already existing path" };
+            variables.erase(variables.begin() + keptCount, variables.end());
         }
 
-        m_Variables.push_back(std::move(variable));
+        //compares namespace paths part by part, which is the depth first order of the NamespaceTree nodes
+        std::weak_ordering CompareNamespacePaths(std::string_view lhs, std::string_view rhs) noexcept
+        {
+            constexpr char PATH_SEPARATOR = ConfigFile::Parser::PATH_SEPARATOR;
+
+            while(true)
+            {
+                const size_t lhsSeparator = lhs.find(PATH_SEPARATOR);
+                const size_t rhsSeparator = rhs.find(PATH_SEPARATOR);
 
-        const Variable& variableToInsert = m_Variables[m_Variables.size() - 1];
+                if(const std::weak_ordering ordering = lhs.substr(0, lhsSeparator) <=> rhs.substr(0, rhsSeparator); ordering != 0)
+                    return ordering;
 
-        const std::string configSource = ResourcesManager::ReceiveFileSource(m_Path);
+                //a namespace is before the ones in it
+                if(lhsSeparator == std::string_view::npos || rhsSeparator == std::string_view::npos)
+                    return (lhsSeparator != std::string_view::npos) <=> (rhsSeparator != std::string_view::npos);
 
-        ResourcesManager::WriteToFile(m_Path, Parser::WriteVariable(configSource, variableToInsert));
+                lhs.remove_prefix(lhsSeparator + 1);
+                rhs.remove_prefix(rhsSeparator + 1);
+            }
+        }
     }
 
-    void ConfigFile::DeleteVariable(const std::string_view& path)
+    struct ConfigFile::ViewStorage
     {
-        const auto it = std::ranges::find_if(m_Variables, [&path](const Variable& variable) { return variable.GetPath() == path; });
-
-        if(it == m_Variables.end())
-            throw std::invalid_argument{ "Failed to find variable" };
+        //the whole file is read, not mapped, because ConfigFile rewrites the same file
+        std::string source;
+        //set instead of source, if the source is shared with the storages of the other threads parsing it
+        std::shared_ptr<const ViewStorage> sourceStorage;
+        //full paths, values with special chars and the caches of arrays
+        std::pmr::monotonic_buffer_resource pool;
+
+        char* Allocate(size_t size)
+        {
+            return static_cast<char*>(pool.allocate(size, alignof(char)));
+        }
+        std::string_view Intern(const std::string_view& prefix, const std::string_view& string)
+        {
+            const size_t size = prefix.size() + string.size();
 
-        m_Variables.erase(it);
+            if(size == 0)
+                return {};
 
-        Parser::DeleteVariable(GetConfigFileSource(), path);
-    }
+            char* data = Allocate(size);
 
-    std::vector<Variable> ConfigFile::ExtractVariablesFromString(const std::string_view& configSource)
-    {
-        std::string path;
+            std::memcpy(data, prefix.data(), prefix.size());
+            std::memcpy(data + prefix.size(), string.data(), string.size());
 
-        std::vector<Variable> variables;
+            return { data, size };
+        }
+        std::string_view InternWithoutSpecialChars(const std::string_view& string)
+        {
+            char* data = Allocate(string.size());
 
-        Parser::ProcessNamespace(variables, path, configSource);
+            return { data, Parser::RemoveSpecialChars(string, data) };
+        }
+    };
 
-        return variables;
-    }
-    std::vector<Variable> ConfigFile::ExtractVariablesFromFile(const std::filesystem::path& configFilePath)
+    ConfigFile::ConfigFile(std::filesystem::path configFilePath, bool createOrOpen, StorageMode storageMode, bool useCompiledCache, uint32_t parsingThreadsCount)
+        : m_Path(std::move(configFilePath)), m_StorageMode(storageMode), m_SaveMode(SaveMode::Atomic), m_UseCompiledCache(useCompiledCache), m_ParsingThreadsCount(parsingThreadsCount), m_VariablesVersion(0)
     {
-        return ExtractVariablesFromString(ResourcesManager::ReceiveFileSource(configFilePath));
+        if(createOrOpen)
+        {
+            try
+            {
+                Load();
+            }
+            catch(...)
+            {
+                ResourcesManager::WriteToFile(m_Path, "", m_SaveMode);
+            }
+        }
+        else
+            Load();
     }
 
-    std::string ConfigFile::GetConfigFileSource() const
-    {
-        return ResourcesManager::ReceiveFileSource(m_Path);
-    }
-    const std::filesystem::path& ConfigFile::GetPath() const
+    ConfigFile::ConfigFile(const ConfigFile& other)
+        : m_Path(other.m_Path), m_StorageMode(other.m_StorageMode), m_SaveMode(other.m_SaveMode), m_UseCompiledCache(other.m_UseCompiledCache), m_ParsingThreadsCount(other.m_ParsingThreadsCount), m_Variables(other.m_Variables), m_VariablesIndex(other.m_VariablesIndex), m_NamespaceTree(other.m_NamespaceTree), m_VariablesVersion(other.m_VariablesVersion), m_SourceSegments(other.m_SourceSegments)
     {
-        return m_Path;
+        if(other.AreConcurrentReadsEnabled())
+            EnableConcurrentReads();
     }
-    const Variable& ConfigFile::GetVariable(const std::string_view& variablePath) const
+    ConfigFile& ConfigFile::operator=(const ConfigFile& other)
     {
-        const auto foundIt = std::ranges::find_if(m_Variables, [&variablePath](const Variable& variable) { return variable.GetPath() == variablePath; });
-
-        if(foundIt == m_Variables.end())
-            throw std::out_of_range("Failed to find variable with path " + std::string{ variablePath });
+        if(this != &other)
+        {
+            m_Path = other.m_Path;
+            m_StorageMode = other.m_StorageMode;
+            m_SaveMode = other.m_SaveMode;
+            m_UseCompiledCache = other.m_UseCompiledCache;
+            m_ParsingThreadsCount = other.m_ParsingThreadsCount;
+            m_Variables = other.m_Variables;
+            m_VariablesIndex = other.m_VariablesIndex;
+            m_NamespaceTree = other.m_NamespaceTree;
+            m_VariablesVersion = other.m_VariablesVersion;
+            m_SourceSegments = other.m_SourceSegments;
+
+            if(other.AreConcurrentReadsEnabled())
+                EnableConcurrentReads();
+            else
+                m_SnapshotPublisher.reset();
+        }
 
-        return *foundIt;
+        return *this;
     }
-    const std::vector<Variable>& ConfigFile::GetVariables() const
+
+    bool ConfigFile::operator==(const ConfigFile& other) const
     {
-        return m_Variables;
+        return m_Path == other.GetPath();
     }
 
-    void ConfigFile::Format(const Parser::StringRange& range) const
+    std::vector<std::string> ConfigFile::Reopen()
     {
-        std::string source = GetConfigFileSource();
+        if(m_UseCompiledCache)
+            return ReplaceVariables(LoadVariables(m_Path, m_StorageMode, m_UseCompiledCache), std::nullopt);
 
-        source = Parser::FormatScope(std::move(source), range);
+        //variables copy what they need, so the mapping can be released right after parsing
+        const ResourcesManager::MappedFile file{ m_Path };
+        const std::string_view source = file.GetSource();
 
-        ResourcesManager::WriteToFile(m_Path, source);
-    }
-}
-//ConfigFile::Parser is garbage
-namespace GuelderResourcesManager
-{
-    ConfigFile::Parser::VariableIndicesInfo& ConfigFile::Parser::VariableIndicesInfo::operator+=(index offset)
-    {
-        type += offset;
-        equals += offset;
-        name += offset;
-        value += offset;
-        semicolon += offset;
+        std::vector<SourceSegment> segments;
 
-        return *this;
-    }
+        if(!m_SourceSegments)
+        {
+            std::vector<Variable> variables = ParseSegmentedVariables(source, m_StorageMode, segments, m_ParsingThreadsCount);
 
-    bool ConfigFile::Parser::IsFullSubstringSame(const std::string_view& string, ConfigFile::Parser::index stringIndexPosition, const std::string_view& substring)
-    {
-        bool result = true;
-        for(index k = 0; stringIndexPosition < string.size() && k < substring.size(); stringIndexPosition++, k++)
-            if(string[stringIndexPosition] != substring[k])
-            {
-                result = false;
-                break;
-            }
+            return ReplaceVariables(std::move(variables), std::move(segments));
+        }
 
-        if(result && stringIndexPosition > 0)
-            stringIndexPosition--;
+        constexpr size_t EMPTY_SEGMENT_INDEX = std::numeric_limits<size_t>::max();
 
-        return result;
-    }
+        const std::vector<Parser::StringRange> ranges = Parser::SplitTopLevelScopes(source);
+        const std::vector<SourceSegment>& oldSegments = *m_SourceSegments;
 
-    void ConfigFile::Parser::ProcessNamespace(std::vector<Variable>& variables, std::string& path, const std::string_view& scope)
-    {
-        //omfg the code is such shit
+        //the first variable of every old segment
+        std::vector<size_t> oldSegmentsVariables(oldSegments.size());
+        //sorted by the hash, one allocation instead of a node per segment
+        std::vector<std::pair<uint64_t, size_t>> oldSegmentsByHash;
+        oldSegmentsByHash.reserve(oldSegments.size());
 
-        bool isCommentScopeClosed = true;
-        bool isValueScopeClosed = true;
+        for(size_t segment = 0, variable = 0; segment < oldSegments.size(); variable += oldSegments[segment].variablesCount, segment++)
+        {
+            oldSegmentsVariables[segment] = variable;
 
-        for(index i = 0; i < scope.size(); i++)
+            if(oldSegments[segment].isSelfContained)
+                oldSegmentsByHash.emplace_back(oldSegments[segment].hash, segment);
+        }
+
+        std::sort(oldSegmentsByHash.begin(), oldSegmentsByHash.end());
+
+        //the old segment every range is the same as, EMPTY_SEGMENT_INDEX if the range is parsed again
+        std::vector<size_t> keptSegments(ranges.size(), EMPTY_SEGMENT_INDEX);
+        std::vector<bool> isSegmentKept(oldSegments.size(), false);
+
+        for(size_t r = 0; r < ranges.size(); r++)
         {
-            const ParsingDataType parsingDataType = DetermineParsingDataType(scope, i, isCommentScopeClosed, isValueScopeClosed);
+            const std::string_view range = source.substr(ranges[r].begin, ranges[r].end - ranges[r].begin + 1);
+            const uint64_t hash = HashSource(range);
+
+            const auto isSame = [&](size_t segment)
+                {
+                    return !isSegmentKept[segment] && oldSegments[segment].isSelfContained && oldSegments[segment].hash == hash && oldSegments[segment].size == range.size();
+                };
 
-            //ALL indices are INCLUSIVE
+            //the segment in the same place is preferred, so the variables stay where they are
+            size_t keptSegment = EMPTY_SEGMENT_INDEX;
 
-            if(parsingDataType == ParsingDataType::Namespace)
+            if(r < oldSegments.size() && isSame(r))
+                keptSegment = r;
+            else
+                for(auto segment = std::lower_bound(oldSegmentsByHash.cbegin(), oldSegmentsByHash.cend(), std::pair{ hash, size_t{ 0 } }); segment != oldSegmentsByHash.cend() && segment->first == hash; ++segment)
+                    if(isSame(segment->second))
+                    {
+                        keptSegment = segment->second;
+                        break;
+                    }
+
+            if(keptSegment != EMPTY_SEGMENT_INDEX)
             {
-                const NamespaceIndicesInfo namespaceInfo = ReceiveNamespaceInfo(scope, i);
+                keptSegments[r] = keptSegment;
+                isSegmentKept[keptSegment] = true;
+            }
+        }
 
-                //const std::string_view namespaceName{ scope.cbegin() + namespaceInfo.nameBegin, scope.cbegin() + namespaceInfo.nameEnd };
-                //const std::string_view namespaceScope{ scope.cbegin() + namespaceInfo.scopeBegin, scope.cbegin() + namespaceInfo.scopeEnd };
-                const std::string_view namespaceName = namespaceInfo.name.GetSubstring<std::string_view>(scope);
-                const std::string_view namespaceScope = namespaceInfo.scope.GetSubstring<std::string_view>(scope);
+        {
+            bool isUnchanged = ranges.size() == oldSegments.size();
 
-                path += std::format("{}/", namespaceName);
+            for(size_t r = 0; r < ranges.size() && isUnchanged; r++)
+                isUnchanged = keptSegments[r] == r;
 
-                //recursion
-                ProcessNamespace(variables, path, namespaceScope);
+            if(isUnchanged)
+                return {};
+        }
 
-                if(std::ranges::count(path, PATH_SEPARATOR) > 1)
-                    path.erase(std::find(path.rbegin() + 1, path.rend(), PATH_SEPARATOR).base(), path.rbegin().base());
-                else
-                    path.clear();
+        //the first range and the amount of ranges of every run of ranges that are parsed again
+        std::vector<std::pair<size_t, size_t>> runs;
 
-                i = namespaceInfo.scope.end;
-            }
-            else if(parsingDataType == ParsingDataType::Variable)
+        for(size_t r = 0; r < ranges.size(); r++)
+            if(keptSegments[r] == EMPTY_SEGMENT_INDEX)
             {
-                const VariableIndicesInfo variableInfo = ReceiveVariableInfo(scope, i);
+                if(!runs.empty() && runs.back().first + runs.back().second == r)
+                    runs.back().second++;
+                else
+                    runs.emplace_back(r, 1);
+            }
 
-                //const std::string_view variableType{ scope.cbegin() + variableInfo.typeBegin, scope.cbegin() + variableInfo.typeEnd + 1 };
-                //const std::string variableName{ scope.cbegin() + variableInfo.nameBegin, scope.cbegin() + variableInfo.nameEnd };
-                //std::string variableValue{ scope.cbegin() + variableInfo.valueBegin + 1, scope.cbegin() + variableInfo.valueEnd };
+        const auto receiveRunRange = [&ranges](const std::pair<size_t, size_t>& run) -> Parser::StringRange
+            {
+                return { ranges[run.first].begin, ranges[run.first + run.second - 1].end };
+            };
 
-                const std::string_view variableType = variableInfo.type.GetSubstring<std::string_view>(scope);
-                std::string variableName = variableInfo.name.GetSubstring<std::string>(scope);
-                const std::string_view variableValueRaw = variableInfo.value.GetSubstring<std::string_view>(scope);
-                std::string variableValue{ variableValueRaw };
+        //only the changed ranges are copied, the kept variables keep the storages they have got
+        std::shared_ptr<ViewStorage> viewStorage;
 
-                if(!variableInfo.isArray)
-                    for(char specialChar : SPECIAL_CHARS)
-                        for(index j = 0; j < variableValue.size(); j++)
-                            if(j > 0 && variableValue[j] == specialChar && variableValue[j - 1] == SPECIAL_CHAR_SIGN)
-                                variableValue.erase(j - 1, 1);
+        if(m_StorageMode == StorageMode::View)
+        {
+            viewStorage = std::make_shared<ViewStorage>();
 
-                variables.emplace_back(path + std::move(variableName), std::move(variableValue), StringToDataType(variableType), variableInfo.isArray);
+            for(const auto& run : runs)
+            {
+                const Parser::StringRange runRange = receiveRunRange(run);
 
-                i = variableInfo.semicolon;
+                viewStorage->source.append(source.substr(runRange.begin, runRange.end - runRange.begin + 1));
             }
         }
-    }
-
-    //idk it is better to make code of those two func clearer but how?
-    ConfigFile::Parser::NamespaceIndicesInfo ConfigFile::Parser::ReceiveNamespaceInfo(const std::string_view& scope, const index& namespaceKeywordBeginIndex)
-    {
-        const index namespaceKeywordEndIndex = namespaceKeywordBeginIndex + NAMESPACE_KEYWORD.size() - 1;
 
-        index namespaceNameBeginIndex = namespaceKeywordEndIndex + 1;
+        std::vector<Variable> parsedVariables;
+        std::vector<SourceSegment> parsedSegments;
+        //the end of the parsed segments of every run
+        std::vector<size_t> runsSegmentsEnds;
+        runsSegmentsEnds.reserve(runs.size());
 
-        //
-        for(bool isCommented = false; namespaceNameBeginIndex < scope.size(); namespaceNameBeginIndex++)
+        for(size_t run = 0, storageOffset = 0; run < runs.size(); run++)
         {
-            char currentChar = scope[namespaceNameBeginIndex];
+            const auto [firstRange, rangesCount] = runs[run];
+            const Parser::StringRange runRange = receiveRunRange(runs[run]);
+            const size_t runSize = runRange.end - runRange.begin + 1;
 
-            if(isCommented && currentChar == NEWLINE)
-                isCommented = false;
-            else if(!isCommented)
+            std::string_view runSource = source.substr(runRange.begin, runSize);
+
+            if(viewStorage)
             {
-                if(IsFullSubstringSame(scope, namespaceNameBeginIndex, COMMENT_SCOPE_LINE))
-                    isCommented = true;
-                else if(Variable::IsValidVariableChar(currentChar))
-                    break;
+                runSource = std::string_view{ viewStorage->source }.substr(storageOffset, runSize);
+                storageOffset += runSize;
             }
-        }
 
-        index namespaceNameEndIndex = namespaceNameBeginIndex + 1;//
+            std::vector<Parser::StringRange> runRanges{ ranges.cbegin() + firstRange, ranges.cbegin() + firstRange + rangesCount };
 
-        index namespaceScopeBeginIndex = namespaceNameEndIndex + 1;
+            for(Parser::StringRange& range : runRanges)
+                range -= runRange.begin;
 
-        //
-        for(bool isCommented = false; namespaceScopeBeginIndex < scope.size(); namespaceScopeBeginIndex++)
-        {
-            char currentChar = scope[namespaceScopeBeginIndex];
+            ParseSegments(parsedVariables, parsedSegments, runSource, runRanges, viewStorage, m_ParsingThreadsCount);
 
-            if(isCommented && currentChar == NEWLINE)
-                isCommented = false;
-            else if(!isCommented)
+            //the next kept segment would be parsed differently after this one, so everything is parsed again
+            if(!parsedSegments.back().isSelfContained && firstRange + rangesCount < ranges.size())
             {
-                if(IsFullSubstringSame(scope, namespaceScopeBeginIndex, COMMENT_SCOPE_LINE))
-                    isCommented = true;
-                else if(Variable::IsValidVariableChar(currentChar))
-                    namespaceNameEndIndex = namespaceScopeBeginIndex;
-                else if(currentChar == SCOPE_OPEN)
-                    break;
+                std::vector<Variable> variables = ParseSegmentedVariables(source, m_StorageMode, segments, m_ParsingThreadsCount);
+
+                return ReplaceVariables(std::move(variables), std::move(segments));
             }
+
+            runsSegmentsEnds.push_back(parsedSegments.size());
         }
 
-        //wft? it could be done via DetermineParsingDataType
-        //TODO: maybe make here a loop and use DetermineParsingDataType
-        index namespaceScopeEndIndex = namespaceScopeBeginIndex + 1;
+        //the new segments in order: whether it is kept and the index of the old or the parsed segment
+        std::vector<std::pair<bool, size_t>> newSegments;
+        newSegments.reserve(ranges.size());
 
-        bool isValueScopeClosed = true;
-        bool isCommentScopeClosed = true;
+        for(size_t r = 0, run = 0, parsedSegment = 0; r < ranges.size(); r++)
+            if(keptSegments[r] != EMPTY_SEGMENT_INDEX)
+                newSegments.emplace_back(true, keptSegments[r]);
+            else if(run < runs.size() && runs[run].first == r)
+            {
+                for(; parsedSegment < runsSegmentsEnds[run]; parsedSegment++)
+                    newSegments.emplace_back(false, parsedSegment);
+
+                run++;
+            }
+
+        std::vector<std::string> changedPaths;
 
-        for(size_t openScopeCount = 1, closeScopeCount = 0; namespaceScopeEndIndex < scope.size() && openScopeCount != closeScopeCount; namespaceScopeEndIndex++)
         {
-            const char currentChar = scope[namespaceScopeEndIndex];
+            std::vector<const Variable*> oldVariables;
 
-            if(isValueScopeClosed)
-            {
-                if(isCommentScopeClosed && IsFullSubstringSame(scope, namespaceScopeEndIndex, COMMENT_SCOPE_LINE))
-                    isCommentScopeClosed = false;
-                else if(currentChar == NEWLINE)
-                    isCommentScopeClosed = true;
-            }
-            if(isCommentScopeClosed)
-            {
-                if(currentChar == VARIABLE_VALUE_SCOPE)
-                {
-                    //if(!isValueScopeClosed && namespaceScopeEndIndex > 0 && scope[namespaceScopeEndIndex - 1] != SPECIAL_CHAR_SIGN)
+            for(size_t segment = 0; segment < oldSegments.size(); segment++)
+                if(!isSegmentKept[segment])
+                    for(size_t variable = 0; variable < oldSegments[segment].variablesCount; variable++)
+                        oldVariables.push_back(&m_Variables[oldSegmentsVariables[segment] + variable]);
 
-                    //if(!isValueScopeClosed && specialCharSignCount % 2 == 0)
+            std::vector<const Variable*> newVariables;
+            newVariables.reserve(parsedVariables.size());
 
-                        //isValueScopeClosed = true;
-                    //else
-                        //isValueScopeClosed = false;
+            for(const Variable& variable : parsedVariables)
+                newVariables.push_back(&variable);
 
-                    if(!isValueScopeClosed)
-                    {
-                        size_t specialCharSignCount = 0;
-                        for(index i = namespaceScopeEndIndex - 1; i > 0; i--)
-                        {
-                            char _currentChar = scope[i];
-                            if(_currentChar == SPECIAL_CHAR_SIGN)
-                                specialCharSignCount++;
-                            else
-                                break;
-                        }
+            changedPaths = ReceiveChangedPaths(oldVariables, newVariables);
+        }
 
-                        if(specialCharSignCount % 2 == 0)
-                            isValueScopeClosed = true;
-                    }
-                    else
-                        isValueScopeClosed = false;
+        std::vector<size_t> parsedSegmentsVariables(parsedSegments.size());
+
+        for(size_t segment = 0, variable = 0; segment < parsedSegments.size(); variable += parsedSegments[segment].variablesCount, segment++)
+            parsedSegmentsVariables[segment] = variable;
+
+        //if every segment stays in its place and keeps the amount of variables, the parsed variables replace the old ones, so the kept ones aren't even moved
+        bool canReplaceInPlace = newSegments.size() == oldSegments.size();
+
+        for(size_t segment = 0; segment < newSegments.size() && canReplaceInPlace; segment++)
+        {
+            const auto [isKept, index] = newSegments[segment];
+
+            canReplaceInPlace = isKept ? index == segment : parsedSegments[index].variablesCount == oldSegments[segment].variablesCount;
+        }
+
+        bool areIndicesOutdated = !canReplaceInPlace;
+
+        segments.reserve(newSegments.size());
+
+        if(canReplaceInPlace)
+        {
+            for(size_t segment = 0; segment < newSegments.size(); segment++)
+            {
+                const auto [isKept, index] = newSegments[segment];
+
+                if(isKept)
+                {
+                    segments.push_back(oldSegments[index]);
+                    continue;
                 }
-                else if(isValueScopeClosed)
+
+                for(size_t variable = 0; variable < parsedSegments[index].variablesCount; variable++)
                 {
-                    if(currentChar == SCOPE_OPEN)
-                        openScopeCount++;
-                    else if(currentChar == SCOPE_CLOSE)
-                        closeScopeCount++;
+                    Variable& oldVariable = m_Variables[oldSegmentsVariables[segment] + variable];
+                    Variable& parsedVariable = parsedVariables[parsedSegmentsVariables[index] + variable];
+
+                    if(oldVariable.GetPath() != parsedVariable.GetPath())
+                        areIndicesOutdated = true;
+
+                    oldVariable = std::move(parsedVariable);
                 }
+
+                segments.push_back(parsedSegments[index]);
             }
         }
+        else
+        {
+            std::vector<Variable> variables;
+            variables.reserve(m_Variables.size() + parsedVariables.size());
 
-        //auto dbg1 = std::string_view{scope.begin() + namespaceScopeBeginIndex, scope.begin() + namespaceScopeEndIndex};
+            for(const auto& [isKept, index] : newSegments)
+            {
+                Variable* const first = isKept ? &m_Variables[oldSegmentsVariables[index]] : &parsedVariables[parsedSegmentsVariables[index]];
+                const SourceSegment& segment = isKept ? oldSegments[index] : parsedSegments[index];
 
-        namespaceScopeEndIndex--;
+                variables.insert(variables.end(), std::make_move_iterator(first), std::make_move_iterator(first + segment.variablesCount));
+                segments.push_back(segment);
+            }
 
-        return
-        {
-            {namespaceKeywordBeginIndex, namespaceKeywordEndIndex},
-            {namespaceNameBeginIndex, namespaceNameEndIndex},
-            {namespaceScopeBeginIndex, namespaceScopeEndIndex}
-        };
+            m_Variables = std::move(variables);
+        }
+
+        m_SourceSegments = std::move(segments);
+
+        //otherwise every variable keeps its path and place, so neither the indices nor the published snapshot change
+        if(areIndicesOutdated)
+            UpdateVariablesIndices();
+        //the values are replaced in place, so the indices stay but a Schema has to read them again
+        else if(!changedPaths.empty())
+            UpdateVariablesVersion();
+        if(areIndicesOutdated || !changedPaths.empty())
+            PublishSnapshot();
+
+        return changedPaths;
     }
-    ConfigFile::Parser::VariableIndicesInfo ConfigFile::Parser::ReceiveVariableInfo(const std::string_view& scope, const index& variableTypeBeginIndex)
+
+    std::vector<Variable> ConfigFile::LoadVariables(const std::filesystem::path& configFilePath, StorageMode storageMode, bool useCompiledCache)
     {
-        index variableTypeEndIndex = variableTypeBeginIndex + 1;
+        if(!useCompiledCache)
+        {
+            if(storageMode == StorageMode::View)
+                return ParseVariables(ResourcesManager::ReceiveFileSource(configFilePath), storageMode);
+            else
+                return ExtractVariablesFromFile(configFilePath);
+        }
 
-        char currentChar;
+        const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(configFilePath);
+        const std::filesystem::path cachePath = CompiledCache::GetCachePath(configFilePath);
+
+        std::vector<Variable> variables;
+        CompiledCache::SourceKey sourceKey;
 
-        for(; variableTypeEndIndex < scope.size(); variableTypeEndIndex++)
         {
-            currentChar = scope[variableTypeEndIndex];
+            //the source has to be read anyway to check the hash
+            const ResourcesManager::MappedFile file{ configFilePath };
 
-            if(!Variable::IsValidVariableChar(currentChar))
-                break;
+            sourceKey = CompiledCache::ReceiveSourceKey(file.GetSource(), writeTime);
+
+            if(auto cachedVariables = CompiledCache::Read(cachePath, sourceKey, storageMode))
+                return std::move(*cachedVariables);
+
+            if(storageMode == StorageMode::View)
+                variables = ParseVariables(std::string{ file.GetSource() }, storageMode);
+            else
+                variables = ExtractVariablesFromString(file.GetSource());
         }
 
-        variableTypeEndIndex--;
+        //the cache only speeds up the next load, e.g. the directory may be read-only
+        try
+        {
+            CompiledCache::Write(cachePath, sourceKey, variables);
+        }
+        catch(const std::exception&)
+        {
+        }
 
-        index variableNameBeginIndex = variableTypeEndIndex + 1;
+        return variables;
+    }
+    std::vector<Variable> ConfigFile::ParseVariables(std::string source, StorageMode storageMode)
+    {
+        if(storageMode != StorageMode::View)
+            return ExtractVariablesFromString(source);
 
-        for(bool isCommented = false; variableNameBeginIndex < scope.size(); variableNameBeginIndex++)
+        const std::shared_ptr<ViewStorage> storage = std::make_shared<ViewStorage>();
+        storage->source = std::move(source);
+
+        std::string path;
+        std::vector<Variable> variables;
+
+        Parser::ProcessTokens(variables, path, storage->source, Parser::Tokenize(storage->source), storage);
+
+        return variables;
+    }
+    std::vector<Variable> ConfigFile::ParseSegmentedVariables(const std::string_view& source, StorageMode storageMode, std::vector<SourceSegment>& segments, uint32_t threadsCount)
+    {
+        std::vector<Variable> variables;
+
+        segments.clear();
+
+        if(storageMode != StorageMode::View)
         {
-            currentChar = scope[variableNameBeginIndex];
+            ParseSegments(variables, segments, source, Parser::SplitTopLevelScopes(source), nullptr, threadsCount);
 
-            if(isCommented && currentChar == NEWLINE)
-                isCommented = false;
-            else if(!isCommented)
-            {
-                if(IsFullSubstringSame(scope, variableNameBeginIndex, COMMENT_SCOPE_LINE))
-                {
-                    isCommented = true;
-                    variableNameBeginIndex += COMMENT_SCOPE_LINE.size() - 1;
-                }
-                else if(Variable::IsValidVariableChar(currentChar))
-                    break;
-            }
+            return variables;
         }
 
-        index variableNameEndIndex = variableNameBeginIndex + 1;
-        for(; variableNameEndIndex < scope.size(); variableNameEndIndex++)
+        const std::shared_ptr<ViewStorage> storage = std::make_shared<ViewStorage>();
+        storage->source = source;
+
+        ParseSegments(variables, segments, storage->source, Parser::SplitTopLevelScopes(storage->source), storage, threadsCount);
+
+        return variables;
+    }
+    void ConfigFile::ParseSegments(std::vector<Variable>& variables, std::vector<SourceSegment>& segments, const std::string_view& source, const std::vector<Parser::StringRange>& ranges, const std::shared_ptr<ViewStorage>& viewStorage, uint32_t threadsCount)
+    {
+        //smaller sources are parsed faster than the threads are started
+        constexpr size_t MIN_PARALLEL_SOURCE_SIZE = 64 * 1024;
+
+        //the buffers are reused by all the ranges of a thread
+        struct ParsingBuffers
         {
-            currentChar = scope[variableNameEndIndex];
+            std::string path;
+            std::vector<Parser::Token> tokens;
+            std::vector<Parser::StructuralBlock> blocks;
+        };
 
-            if(!Variable::IsValidVariableChar(currentChar))
+        const auto parseRange = [](std::vector<Variable>& variables, const std::string_view& segment, ParsingBuffers& buffers, const std::shared_ptr<ViewStorage>& storage)
             {
-                if(variableNameEndIndex > 0)
-                    variableNameEndIndex--;
+                buffers.path.clear();
 
-                break;
-            }
-        }
+                Parser::Tokenize(segment, buffers.tokens, buffers.blocks);
 
-        index equalsIndex = variableNameEndIndex + 1;
-        for(bool isCommented = false; equalsIndex < scope.size(); equalsIndex++)
-        {
-            currentChar = scope[equalsIndex];
+                return Parser::ProcessTokens(variables, buffers.path, segment, buffers.tokens, storage);
+            };
 
-            if(isCommented && currentChar == NEWLINE)
-                isCommented = false;
-            else if(!isCommented)
+        const auto parseSequentially = [&](size_t firstRange)
             {
-                if(IsFullSubstringSame(scope, equalsIndex, COMMENT_SCOPE_LINE))
+                ParsingBuffers buffers;
+
+                for(size_t r = firstRange; r < ranges.size(); r++)
                 {
-                    isCommented = true;
-                    equalsIndex += COMMENT_SCOPE_LINE.size() - 1;
+                    const size_t variablesCount = variables.size();
+
+                    std::string_view segment = source.substr(ranges[r].begin, ranges[r].end - ranges[r].begin + 1);
+
+                    bool isSelfContained = parseRange(variables, segment, buffers, viewStorage);
+
+                    //the next ranges change the variables of this one, e.g. a semicolon is missing, so the rest of the source is parsed as one segment
+                    if(!isSelfContained && r + 1 < ranges.size())
+                    {
+                        variables.erase(variables.begin() + variablesCount, variables.end());
+
+                        segment = source.substr(ranges[r].begin, ranges.back().end - ranges[r].begin + 1);
+
+                        isSelfContained = parseRange(variables, segment, buffers, viewStorage);
+
+                        r = ranges.size() - 1;
+                    }
+
+                    segments.push_back({ HashSource(segment), segment.size(), variables.size() - variablesCount, isSelfContained });
                 }
-                else if(currentChar == EQUALS)
-                    break;
-            }
-        }
+            };
 
-        bool isArray = false;
+        if(threadsCount == 0)
+            threadsCount = std::max(std::thread::hardware_concurrency(), 1u);
 
-        index variableValueBeginIndex = equalsIndex + 1;
-        for(bool isCommented = false; variableValueBeginIndex < scope.size(); variableValueBeginIndex++)
+        threadsCount = static_cast<uint32_t>(std::min<size_t>(threadsCount, ranges.size()));
+
+        if(threadsCount <= 1 || source.size() < MIN_PARALLEL_SOURCE_SIZE)
         {
-            currentChar = scope[variableValueBeginIndex];
+            parseSequentially(0);
+            return;
+        }
 
-            if(isCommented && currentChar == NEWLINE)
-                isCommented = false;
-            else if(!isCommented)
+        //every range is parsed on its own and the results are joined in the order of the source, so they don't depend on the threads
+        std::vector<std::vector<Variable>> rangesVariables(ranges.size());
+        //not std::vector<bool>, the threads write the neighbouring items
+        std::vector<uint8_t> areSelfContained(ranges.size(), false);
+        std::vector<std::exception_ptr> exceptions(threadsCount);
+
+        std::atomic<size_t> nextRange = 0;
+
+        const auto parse = [&](uint32_t thread)
             {
-                if(IsFullSubstringSame(scope, variableValueBeginIndex, COMMENT_SCOPE_LINE))
+                //the pool of a ViewStorage is not synchronized, so every thread interns into its own storage, which keeps viewStorage with the source alive
+                std::shared_ptr<ViewStorage> threadStorage;
+
+                if(viewStorage)
                 {
-                    isCommented = true;
-                    variableValueBeginIndex += COMMENT_SCOPE_LINE.size() - 1;
+                    threadStorage = std::make_shared<ViewStorage>();
+                    threadStorage->sourceStorage = viewStorage;
                 }
-                else if(currentChar == VARIABLE_VALUE_SCOPE)
-                    break;
-                else if(currentChar == SCOPE_OPEN)
+
+                try
                 {
-                    isArray = true;
-                    break;
+                    ParsingBuffers buffers;
+
+                    for(size_t r = nextRange++; r < ranges.size(); r = nextRange++)
+                    {
+                        const std::string_view segment = source.substr(ranges[r].begin, ranges[r].end - ranges[r].begin + 1);
+
+                        areSelfContained[r] = parseRange(rangesVariables[r], segment, buffers, threadStorage);
+                    }
+                }
+                catch(...)
+                {
+                    exceptions[thread] = std::current_exception();
+                    //the other threads stop after their current ranges
+                    nextRange = ranges.size();
                 }
+            };
+
+        {
+            std::vector<std::jthread> threads;
+            threads.reserve(threadsCount - 1);
+
+            for(uint32_t thread = 1; thread < threadsCount; thread++)
+                threads.emplace_back(parse, thread);
+
+            parse(0);
+        }
+
+        for(const std::exception_ptr& exception : exceptions)
+            if(exception)
+                std::rethrow_exception(exception);
+
+        size_t variablesCount = variables.size();
+        for(const std::vector<Variable>& rangeVariables : rangesVariables)
+            variablesCount += rangeVariables.size();
+
+        variables.reserve(variablesCount);
+
+        for(size_t r = 0; r < ranges.size(); r++)
+        {
+            //the same as the sequential parsing does, the ranges after it are parsed again with it
+            if(!areSelfContained[r] && r + 1 < ranges.size())
+            {
+                parseSequentially(r);
+                return;
             }
+
+            const std::string_view segment = source.substr(ranges[r].begin, ranges[r].end - ranges[r].begin + 1);
+
+            segments.push_back({ HashSource(segment), segment.size(), rangesVariables[r].size(), static_cast<bool>(areSelfContained[r]) });
+            variables.insert(variables.end(), std::make_move_iterator(rangesVariables[r].begin()), std::make_move_iterator(rangesVariables[r].end()));
         }
+    }
+    std::vector<std::string> ConfigFile::ReceiveChangedPaths(const std::vector<const Variable*>& oldVariables, const std::vector<const Variable*>& newVariables)
+    {
+        //if a path repeats, the first one is compared
+        std::unordered_map<std::string_view, const Variable*> oldVariablesByPath;
+        oldVariablesByPath.reserve(oldVariables.size());
 
-        index variableValueEndIndex = variableValueBeginIndex + 1;
-        if(isArray)
-            for(bool isCommented = false, isString = false; variableValueEndIndex < scope.size(); variableValueEndIndex++)
+        for(const Variable* variable : oldVariables)
+            oldVariablesByPath.try_emplace(variable->GetPath(), variable);
+
+        std::vector<std::string> changedPaths;
+        std::unordered_set<std::string_view> newPaths;
+        newPaths.reserve(newVariables.size());
+
+        for(const Variable* variable : newVariables)
+        {
+            if(!newPaths.insert(variable->GetPath()).second)
+                continue;
+
+            const auto oldVariable = oldVariablesByPath.find(variable->GetPath());
+
+            if(oldVariable == oldVariablesByPath.cend())
             {
-                currentChar = scope[variableValueEndIndex];
+                changedPaths.emplace_back(variable->GetPath());
+                continue;
+            }
 
-                if(isCommented && currentChar == NEWLINE)
-                    isCommented = false;
-                else if(!isCommented)
-                {
-                    if(IsFullSubstringSame(scope, variableValueEndIndex, COMMENT_SCOPE_LINE))
-                    {
-                        isCommented = true;
-                        variableValueEndIndex += COMMENT_SCOPE_LINE.size() - 1;
-                    }
-                    //else if(currentChar == VARIABLE_VALUE_SCOPE && (variableValueEndIndex > 0 && scope[variableValueEndIndex - 1] != SPECIAL_CHAR_SIGN || variableValueEndIndex > 1 && scope[variableValueEndIndex - 1] == SPECIAL_CHAR_SIGN && scope[variableValueEndIndex - 2] == SPECIAL_CHAR_SIGN))
-                    else if(currentChar == VARIABLE_VALUE_SCOPE)
-                    {
-                        //TODO: question about specialCharSignCount, maybe variableValueEndIndex - 2? nope it does i--
-                        size_t specialCharSignCount = 0;
-                        for(index i = variableValueEndIndex - 1; i > 0; i--)
-                        {
-                            char _currentChar = scope[i];
-                            if(_currentChar == SPECIAL_CHAR_SIGN)
-                                specialCharSignCount++;
-                            else
-                                break;
-                        }
+            if(!(*oldVariable->second == *variable) || oldVariable->second->IsArray() != variable->IsArray())
+                changedPaths.emplace_back(variable->GetPath());
 
-                        if(specialCharSignCount % 2 == 0)
-                            isString = !isString;
-                    }
-                    else if(!isString && currentChar == SCOPE_CLOSE)
-                        break;
-                }
-            }
+            oldVariablesByPath.erase(oldVariable);
+        }
+
+        //the deleted ones, in the order of oldVariables
+        for(const Variable* variable : oldVariables)
+            if(oldVariablesByPath.erase(variable->GetPath()))
+                changedPaths.emplace_back(variable->GetPath());
+
+        return changedPaths;
+    }
+    void ConfigFile::Load()
+    {
+        if(m_UseCompiledCache)
+        {
+            m_Variables = LoadVariables(m_Path, m_StorageMode, m_UseCompiledCache);
+            m_SourceSegments.reset();
+        }
         else
-            for(; variableValueEndIndex < scope.size(); variableValueEndIndex++)
-            {
-                currentChar = scope[variableValueEndIndex];
-                //auto ___ = scope.cbegin() + variableValueEndIndex;
+        {
+            const ResourcesManager::MappedFile file{ m_Path };
 
-                //if(currentChar == VARIABLE_VALUE_SCOPE && (variableValueEndIndex > 0 && scope[variableValueEndIndex - 1] != SPECIAL_CHAR_SIGN || variableValueEndIndex > 1 && scope[variableValueEndIndex - 1] == SPECIAL_CHAR_SIGN && scope[variableValueEndIndex - 2] == SPECIAL_CHAR_SIGN))
-                if(currentChar == VARIABLE_VALUE_SCOPE)
+            std::vector<SourceSegment> segments;
+
+            m_Variables = ParseSegmentedVariables(file.GetSource(), m_StorageMode, segments, m_ParsingThreadsCount);
+            m_SourceSegments = std::move(segments);
+        }
+
+        UpdateVariablesIndices();
+        PublishSnapshot();
+    }
+    std::vector<std::string> ConfigFile::ReplaceVariables(std::vector<Variable> variables, std::optional<std::vector<SourceSegment>> sourceSegments)
+    {
+        std::vector<std::string> changedPaths;
+
+        {
+            const auto receivePointers = [](const std::vector<Variable>& variables)
                 {
-                    size_t specialCharSignCount = 0;
-                    for(index i = variableValueEndIndex - 1; i > 0; i--)
+                    std::vector<const Variable*> pointers;
+                    pointers.reserve(variables.size());
+
+                    for(const Variable& variable : variables)
+                        pointers.push_back(&variable);
+
+                    return pointers;
+                };
+
+            changedPaths = ReceiveChangedPaths(receivePointers(m_Variables), receivePointers(variables));
+        }
+
+        m_Variables = std::move(variables);
+        m_SourceSegments = std::move(sourceSegments);
+
+        UpdateVariablesIndices();
+        PublishSnapshot();
+
+        return changedPaths;
+    }
+
+    void ConfigFile::WriteVariable(Variable variable)
+    {
+        BeginTransaction().WriteVariable(std::move(variable)).Commit();
+    }
+
+    void ConfigFile::DeleteVariable(const std::string_view& path)
+    {
+        BeginTransaction().DeleteVariable(path).Commit();
+    }
+    void ConfigFile::DeleteNamespace(const std::string_view& namespacePath)
+    {
+        std::string configSource = ResourcesManager::ReceiveFileSource(m_Path);
+
+        Parser::SourceIndex sourceIndex{ configSource };
+
+        if(!sourceIndex.DoesNamespaceExist(namespacePath))
+            throw std::invalid_argument{ "Failed to find namespace" };
+
+        //a namespace may be opened several times, its variables are merged
+        do
+            configSource = Parser::DeleteNamespace(std::move(configSource), namespacePath, sourceIndex);
+        while(sourceIndex.DoesNamespaceExist(namespacePath));
+
+        ResourcesManager::WriteToFile(m_Path, configSource, m_SaveMode);
+
+        const size_t node = m_NamespaceTree.Find(namespacePath);
+
+        if(node == NamespaceTree::EMPTY_NODE)
+            return;
+
+        std::vector<bool> toDelete(m_Variables.size(), false);
+
+        for(const size_t variableIndex : m_NamespaceTree.GetVariableIndicesUnder(node))
+            toDelete[variableIndex] = true;
+
+        EraseVariables(m_Variables, toDelete);
+
+        m_SourceSegments.reset();
+
+        UpdateVariablesIndices();
+        PublishSnapshot();
+    }
+
+    ConfigFile::Transaction ConfigFile::BeginTransaction()
+    {
+        return Transaction{ *this };
+    }
+
+    std::vector<Variable> ConfigFile::ExtractVariablesFromString(const std::string_view& configSource)
+    {
+        std::string path;
+
+        std::vector<Variable> variables;
+
+        Parser::ProcessNamespace(variables, path, configSource);
+
+        return variables;
+    }
+    std::vector<Variable> ConfigFile::ExtractVariablesFromFile(const std::filesystem::path& configFilePath)
+    {
+        //variables copy what they need, so the mapping can be released right after parsing
+        const ResourcesManager::MappedFile file{ configFilePath };
+
+        return ExtractVariablesFromString(file.GetSource());
+    }
+
+    std::string ConfigFile::GetConfigFileSource() const
+    {
+        return ResourcesManager::ReceiveFileSource(m_Path);
+    }
+    const std::filesystem::path& ConfigFile::GetPath() const
+    {
+        return m_Path;
+    }
+    ConfigFile::StorageMode ConfigFile::GetStorageMode() const noexcept
+    {
+        return m_StorageMode;
+    }
+    SaveMode ConfigFile::GetSaveMode() const noexcept
+    {
+        return m_SaveMode;
+    }
+    void ConfigFile::SetSaveMode(SaveMode saveMode) noexcept
+    {
+        m_SaveMode = saveMode;
+    }
+    bool ConfigFile::IsCompiledCacheEnabled() const noexcept
+    {
+        return m_UseCompiledCache;
+    }
+    void ConfigFile::SetCompiledCacheEnabled(bool isEnabled) noexcept
+    {
+        m_UseCompiledCache = isEnabled;
+    }
+    uint32_t ConfigFile::GetParsingThreadsCount() const noexcept
+    {
+        return m_ParsingThreadsCount;
+    }
+    void ConfigFile::SetParsingThreadsCount(uint32_t parsingThreadsCount) noexcept
+    {
+        m_ParsingThreadsCount = parsingThreadsCount;
+    }
+
+    void ConfigFile::EnableConcurrentReads()
+    {
+        if(!m_SnapshotPublisher)
+            m_SnapshotPublisher = std::make_unique<SnapshotPublisher>();
+
+        PublishSnapshot();
+    }
+    bool ConfigFile::AreConcurrentReadsEnabled() const noexcept
+    {
+        return m_SnapshotPublisher != nullptr;
+    }
+    std::shared_ptr<const ConfigFile::Snapshot> ConfigFile::GetSnapshot() const
+    {
+        return GetSnapshotPublisher().GetSnapshot();
+    }
+    const ConfigFile::SnapshotPublisher& ConfigFile::GetSnapshotPublisher() const
+    {
+        if(!m_SnapshotPublisher)
+            throw std::logic_error{ "Concurrent reads are disabled" };
+
+        return *m_SnapshotPublisher;
+    }
+    const Variable& ConfigFile::GetVariable(const std::string_view& variablePath) const
+    {
+        const size_t variableIndex = FindVariableIndex(variablePath);
+
+        if(variableIndex == EMPTY_VARIABLE_INDEX)
+            throw std::out_of_range("Failed to find variable with path " + std::string{ variablePath });
+
+        return m_Variables[variableIndex];
+    }
+    const Variable* ConfigFile::FindVariable(const std::string_view& variablePath) const noexcept
+    {
+        const size_t variableIndex = FindVariableIndex(variablePath);
+
+        return variableIndex != EMPTY_VARIABLE_INDEX ? &m_Variables[variableIndex] : nullptr;
+    }
+    const std::vector<Variable>& ConfigFile::GetVariables() const
+    {
+        return m_Variables;
+    }
+    const ConfigFile::NamespaceTree& ConfigFile::GetNamespaceTree() const noexcept
+    {
+        return m_NamespaceTree;
+    }
+    std::vector<const Variable*> ConfigFile::GetVariablesUnder(const std::string_view& namespacePath) const
+    {
+        const size_t node = m_NamespaceTree.Find(namespacePath);
+
+        if(node == NamespaceTree::EMPTY_NODE)
+            return {};
+
+        const std::span<const size_t> variableIndices = m_NamespaceTree.GetVariableIndicesUnder(node);
+
+        std::vector<const Variable*> variables;
+        variables.reserve(variableIndices.size());
+
+        for(const size_t variableIndex : variableIndices)
+            variables.push_back(&m_Variables[variableIndex]);
+
+        return variables;
+    }
+
+    size_t ConfigFile::FindVariableIndex(const std::string_view& variablePath) const noexcept
+    {
+        return m_VariablesIndex.Find(m_Variables, variablePath);
+    }
+    void ConfigFile::UpdateVariablesIndices()
+    {
+        m_VariablesIndex.Update(m_Variables);
+        m_NamespaceTree = NamespaceTree{ m_Variables };
+
+        UpdateVariablesVersion();
+    }
+    void ConfigFile::UpdateVariablesVersion() noexcept
+    {
+        //unique among all ConfigFiles, so a Schema notices when another ConfigFile is assigned to the one it reads
+        static std::atomic<uint64_t> variablesVersionsCount = 0;
+
+        m_VariablesVersion = ++variablesVersionsCount;
+    }
+    void ConfigFile::PublishSnapshot()
+    {
+        //the readers may hold the previous snapshot, so the variables are copied. The copies share the strings, so only the vectors are allocated
+        if(m_SnapshotPublisher)
+            m_SnapshotPublisher->Publish(std::shared_ptr<const Snapshot>{ new Snapshot{ m_Variables, m_VariablesIndex } });
+    }
+
+    size_t ConfigFile::VariablesIndex::Find(const std::vector<Variable>& variables, const std::string_view& variablePath) const noexcept
+    {
+        if(slots.empty())
+            return EMPTY_VARIABLE_INDEX;
+
+        const size_t mask = slots.size() - 1;
+
+        for(size_t slot = std::hash<std::string_view>{}(variablePath) & mask; ; slot = (slot + 1) & mask)
+        {
+            const size_t variableIndex = slots[slot];
+
+            if(variableIndex == EMPTY_VARIABLE_INDEX || variables[variableIndex].GetPath() == variablePath)
+                return variableIndex;
+        }
+    }
+    void ConfigFile::VariablesIndex::Update(const std::vector<Variable>& variables)
+    {
+        constexpr size_t MIN_SLOTS_COUNT = 16;
+
+        //the load factor is kept under 0.5
+        slots.assign(std::max(std::bit_ceil(variables.size() * 2 + 1), MIN_SLOTS_COUNT), EMPTY_VARIABLE_INDEX);
+
+        //if there are several variables with the same path, the first one is found, as before
+        for(size_t i = 0; i < variables.size(); i++)
+            Add(variables, i);
+    }
+    void ConfigFile::VariablesIndex::Add(const std::vector<Variable>& variables, size_t variableIndex)
+    {
+        if(slots.size() < (variableIndex + 1) * 2)
+        {
+            Update(variables);
+
+            return;
+        }
+
+        const size_t mask = slots.size() - 1;
+
+        size_t slot = std::hash<std::string_view>{}(variables[variableIndex].GetPath()) & mask;
+
+        while(slots[slot] != EMPTY_VARIABLE_INDEX)
+            slot = (slot + 1) & mask;
+
+        slots[slot] = variableIndex;
+    }
+
+    ConfigFile::NamespaceTree::NamespaceTree()
+        : m_Nodes{ Node{ 0, 0, 0, std::numeric_limits<uint32_t>::max(), 1, 0, 0 } } {
+    }
+    ConfigFile::NamespaceTree::NamespaceTree(const std::vector<Variable>& variables)
+    {
+        //the nodes are created in the order they are met, then renumbered depth first
+        struct UnorderedNode
+        {
+            //points into the path of a variable
+            std::string_view path;
+            size_t nameSize;
+            size_t parent;
+            std::vector<size_t> children;
+        };
+
+        std::vector<UnorderedNode> unorderedNodes{ UnorderedNode{ {}, 0, EMPTY_NODE, {} } };
+        std::unordered_map<std::string_view, size_t> nodesByPath{ { std::string_view{}, ROOT_NODE } };
+
+        const auto receiveNode = [&unorderedNodes, &nodesByPath](const std::string_view& path)
+            {
+                if(const auto node = nodesByPath.find(path); node != nodesByPath.end())
+                    return node->second;
+
+                //the closest namespace above path that has a node, the ones below it are created from the top
+                size_t parent = ROOT_NODE;
+                size_t nameBegin = 0;
+
+                for(size_t separator = path.rfind(Parser::PATH_SEPARATOR); separator != std::string_view::npos && separator > 0; separator = path.rfind(Parser::PATH_SEPARATOR, separator - 1))
+                    if(const auto node = nodesByPath.find(path.substr(0, separator)); node != nodesByPath.end())
                     {
-                        char _currentChar = scope[i];
-                        if(_currentChar == SPECIAL_CHAR_SIGN)
-                            specialCharSignCount++;
-                        else
-                            break;
-                    }
+                        parent = node->second;
+                        nameBegin = separator + 1;
 
-                    if(specialCharSignCount % 2 == 0)
                         break;
+                    }
+
+                while(true)
+                {
+                    const size_t nameEnd = std::min(path.find(Parser::PATH_SEPARATOR, nameBegin), path.size());
+                    const size_t node = unorderedNodes.size();
+
+                    unorderedNodes.push_back(UnorderedNode{ path.substr(0, nameEnd), nameEnd - nameBegin, parent, {} });
+                    unorderedNodes[parent].children.push_back(node);
+                    nodesByPath.emplace(path.substr(0, nameEnd), node);
+
+                    if(nameEnd == path.size())
+                        return node;
+
+                    parent = node;
+                    nameBegin = nameEnd + 1;
                 }
-            }
+            };
+
+        std::vector<size_t> variableNodes;
+        variableNodes.reserve(variables.size());
 
-        index variableValueSemicolon = variableValueEndIndex + 1;
-        for(bool isCommented = false; variableValueSemicolon < scope.size(); variableValueSemicolon++)
         {
-            currentChar = scope[variableValueSemicolon];
+            std::string_view previousPath;
+            size_t previousNode = ROOT_NODE;
 
-            if(isCommented && currentChar == NEWLINE)
-                isCommented = false;
-            else if(!isCommented)
+            for(const Variable& variable : variables)
             {
-                if(IsFullSubstringSame(scope, variableValueSemicolon, COMMENT_SCOPE_LINE))
+                const std::string_view variablePath = variable.GetPath();
+                const size_t separator = variablePath.rfind(Parser::PATH_SEPARATOR);
+                const std::string_view path = separator != std::string_view::npos ? variablePath.substr(0, separator) : std::string_view{};
+
+                //the variables of a namespace are usually next to each other
+                if(path != previousPath)
                 {
-                    isCommented = true;
-                    variableValueSemicolon += COMMENT_SCOPE_LINE.size() - 1;
+                    previousNode = receiveNode(path);
+                    previousPath = path;
                 }
-                else if(currentChar == SEMICOLON)
-                    break;
+
+                variableNodes.push_back(previousNode);
             }
         }
 
-        if(variableValueBeginIndex == variableValueEndIndex - 1)
+        const auto receiveName = [&unorderedNodes](size_t node)
+            {
+                const UnorderedNode& unorderedNode = unorderedNodes[node];
+
+                return unorderedNode.path.substr(unorderedNode.path.size() - unorderedNode.nameSize);
+            };
+
+        //depth first, the children by name
+        std::vector<size_t> order;
+        std::vector<size_t> newIndices(unorderedNodes.size());
+        order.reserve(unorderedNodes.size());
+
         {
-            variableValueBeginIndex = std::string::npos;
-            variableValueEndIndex = std::string::npos;
+            std::vector<size_t> stack{ ROOT_NODE };
+
+            while(!stack.empty())
+            {
+                const size_t node = stack.back();
+                stack.pop_back();
+
+                newIndices[node] = order.size();
+                order.push_back(node);
+
+                std::vector<size_t>& children = unorderedNodes[node].children;
+
+                std::ranges::sort(children, std::greater{}, receiveName);
+                stack.insert(stack.end(), children.cbegin(), children.cend());
+            }
         }
-        else
+
+        std::vector<uint32_t> variablesCounts(order.size(), 0);
+
+        for(const size_t node : variableNodes)
+            variablesCounts[newIndices[node]]++;
+
+        m_Nodes.resize(order.size());
+
+        size_t pathsSize = 0;
+
+        for(const UnorderedNode& unorderedNode : unorderedNodes)
+            pathsSize += unorderedNode.path.size();
+
+        m_Paths.reserve(pathsSize);
+
+        for(size_t i = 0, variablesBegin = 0; i < order.size(); i++)
         {
-            if(!isArray)
+            const UnorderedNode& unorderedNode = unorderedNodes[order[i]];
+
+            m_Nodes[i] = Node
             {
-                variableValueBeginIndex++;
-                variableValueEndIndex--;
-            }
+                static_cast<uint32_t>(m_Paths.size()),
+                static_cast<uint32_t>(unorderedNode.path.size()),
+                static_cast<uint32_t>(unorderedNode.nameSize),
+                unorderedNode.parent != EMPTY_NODE ? static_cast<uint32_t>(newIndices[unorderedNode.parent]) : std::numeric_limits<uint32_t>::max(),
+                static_cast<uint32_t>(i + 1),
+                static_cast<uint32_t>(variablesBegin),
+                variablesCounts[i]
+            };
+
+            m_Paths += unorderedNode.path;
+            variablesBegin += variablesCounts[i];
         }
 
+        //a parent is before its children, so going backwards every subtree is complete before it is added to the parent's
+        for(size_t i = order.size() - 1; i > 0; i--)
+            m_Nodes[m_Nodes[i].parent].subtreeEnd = std::max(m_Nodes[m_Nodes[i].parent].subtreeEnd, m_Nodes[i].subtreeEnd);
+
+        m_VariableIndices.resize(variables.size());
+
+        std::vector<uint32_t> variablesEnds(order.size());
+
+        for(size_t i = 0; i < order.size(); i++)
+            variablesEnds[i] = m_Nodes[i].variablesBegin;
+
+        for(size_t i = 0; i < variables.size(); i++)
+            m_VariableIndices[variablesEnds[newIndices[variableNodes[i]]]++] = i;
+    }
+
+    size_t ConfigFile::NamespaceTree::Find(const std::string_view& namespacePath) const noexcept
+    {
+        std::string_view path = namespacePath;
+
+        if(path.ends_with(Parser::PATH_SEPARATOR))
+            path.remove_suffix(1);
+
+        const auto node = std::ranges::lower_bound(m_Nodes, path, [](const std::string_view& lhs, const std::string_view& rhs) { return CompareNamespacePaths(lhs, rhs) < 0; },
+            [this](const Node& node) { return std::string_view{ m_Paths }.substr(node.pathBegin, node.pathSize); });
+
+        if(node == m_Nodes.end() || std::string_view{ m_Paths }.substr(node->pathBegin, node->pathSize) != path)
+            return EMPTY_NODE;
+
+        return node - m_Nodes.begin();
+    }
+
+    std::string_view ConfigFile::NamespaceTree::GetPath(size_t node) const
+    {
+        const Node& foundNode = GetNode(node);
+
+        return std::string_view{ m_Paths }.substr(foundNode.pathBegin, foundNode.pathSize);
+    }
+    std::string_view ConfigFile::NamespaceTree::GetName(size_t node) const
+    {
+        const Node& foundNode = GetNode(node);
+
+        return std::string_view{ m_Paths }.substr(foundNode.pathBegin + foundNode.pathSize - foundNode.nameSize, foundNode.nameSize);
+    }
+    size_t ConfigFile::NamespaceTree::GetParent(size_t node) const
+    {
+        const uint32_t parent = GetNode(node).parent;
+
+        return parent != std::numeric_limits<uint32_t>::max() ? parent : EMPTY_NODE;
+    }
+    std::vector<size_t> ConfigFile::NamespaceTree::GetChildren(size_t node) const
+    {
+        std::vector<size_t> children;
+
+        for(size_t child = node + 1; child < GetNode(node).subtreeEnd; child = m_Nodes[child].subtreeEnd)
+            children.push_back(child);
+
+        return children;
+    }
+    size_t ConfigFile::NamespaceTree::GetSubtreeEnd(size_t node) const
+    {
+        return GetNode(node).subtreeEnd;
+    }
+    std::span<const size_t> ConfigFile::NamespaceTree::GetVariableIndices(size_t node) const
+    {
+        const Node& foundNode = GetNode(node);
+
+        return std::span{ m_VariableIndices }.subspan(foundNode.variablesBegin, foundNode.variablesCount);
+    }
+    std::span<const size_t> ConfigFile::NamespaceTree::GetVariableIndicesUnder(size_t node) const
+    {
+        const Node& foundNode = GetNode(node);
+        const size_t variablesEnd = foundNode.subtreeEnd < m_Nodes.size() ? m_Nodes[foundNode.subtreeEnd].variablesBegin : m_VariableIndices.size();
+
+        return std::span{ m_VariableIndices }.subspan(foundNode.variablesBegin, variablesEnd - foundNode.variablesBegin);
+    }
+    size_t ConfigFile::NamespaceTree::GetNodesCount() const noexcept
+    {
+        return m_Nodes.size();
+    }
+
+    const ConfigFile::NamespaceTree::Node& ConfigFile::NamespaceTree::GetNode(size_t node) const
+    {
+        if(node >= m_Nodes.size())
+            throw std::out_of_range{ "Failed to find namespace node" };
+
+        return m_Nodes[node];
+    }
+
+    ConfigFile::Snapshot::Snapshot(std::vector<Variable> variables)
+        : m_Variables(std::move(variables))
+    {
+        m_VariablesIndex.Update(m_Variables);
+    }
+    ConfigFile::Snapshot::Snapshot(std::vector<Variable> variables, VariablesIndex variablesIndex)
+        : m_Variables(std::move(variables)), m_VariablesIndex(std::move(variablesIndex)) {
+    }
+
+    const Variable& ConfigFile::Snapshot::GetVariable(const std::string_view& variablePath) const
+    {
+        const Variable* variable = FindVariable(variablePath);
+
+        if(!variable)
+            throw std::out_of_range("Failed to find variable with path " + std::string{ variablePath });
+
+        return *variable;
+    }
+    const Variable* ConfigFile::Snapshot::FindVariable(const std::string_view& variablePath) const noexcept
+    {
+        const size_t variableIndex = m_VariablesIndex.Find(m_Variables, variablePath);
+
+        return variableIndex != EMPTY_VARIABLE_INDEX ? &m_Variables[variableIndex] : nullptr;
+    }
+    const std::vector<Variable>& ConfigFile::Snapshot::GetVariables() const noexcept
+    {
+        return m_Variables;
+    }
+
+    ConfigFile::SnapshotPublisher::SnapshotPublisher(std::shared_ptr<const Snapshot> snapshot)
+        : m_Snapshot(std::move(snapshot)), m_Version(0) {
+    }
+
+    std::shared_ptr<const ConfigFile::Snapshot> ConfigFile::SnapshotPublisher::Publish(std::shared_ptr<const Snapshot> snapshot) noexcept
+    {
+        std::shared_ptr<const Snapshot> previousSnapshot = m_Snapshot.exchange(std::move(snapshot), std::memory_order_acq_rel);
+
+        //after the snapshot, so a reader that sees the new version also gets the new snapshot
+        m_Version.fetch_add(1, std::memory_order_release);
+
+        return previousSnapshot;
+    }
+
+    std::shared_ptr<const ConfigFile::Snapshot> ConfigFile::SnapshotPublisher::GetSnapshot() const noexcept
+    {
+        return m_Snapshot.load(std::memory_order_acquire);
+    }
+    uint64_t ConfigFile::SnapshotPublisher::GetVersion() const noexcept
+    {
+        return m_Version.load(std::memory_order_acquire);
+    }
+
+    ConfigFile::SnapshotReader::SnapshotReader(const SnapshotPublisher& publisher)
+        : m_Publisher(&publisher), m_Version(publisher.GetVersion())
+    {
+        //the version is loaded first, so a snapshot published in between is loaded again instead of being missed
+        m_Snapshot = publisher.GetSnapshot();
+    }
+
+    const ConfigFile::Snapshot& ConfigFile::SnapshotReader::GetSnapshot()
+    {
+        const uint64_t version = m_Publisher->GetVersion();
+
+        if(version != m_Version)
+        {
+            m_Snapshot = m_Publisher->GetSnapshot();
+            m_Version = version;
+        }
+
+        return *m_Snapshot;
+    }
+
+    void ConfigFile::Format(const Parser::StringRange& range) const
+    {
+        std::string source = GetConfigFileSource();
+
+        source = Parser::FormatScope(std::move(source), range);
+
+        ResourcesManager::WriteToFile(m_Path, source, m_SaveMode);
+    }
+
+    ConfigFile::Transaction::Transaction(ConfigFile& configFile)
+        : m_ConfigFile(&configFile) {
+    }
+
+    ConfigFile::Transaction& ConfigFile::Transaction::WriteVariable(Variable variable)
+    {
+        if(DoesVariableExist(variable.GetPath()))
+            throw std::invalid_argument{ "Cannot add variable with the already existing path" };
+
+        m_StagedPaths.insert_or_assign(std::string{ variable.GetPath() }, true);
+        m_VariablesToWrite.push_back(std::move(variable));
+
+        return *this;
+    }
+    ConfigFile::Transaction& ConfigFile::Transaction::DeleteVariable(const std::string_view& path)
+    {
+        if(!DoesVariableExist(path))
+            throw std::invalid_argument{ "Failed to find variable" };
+
+        const auto [stagedPath, isFirstStaging] = m_StagedPaths.insert_or_assign(std::string{ path }, false);
+
+        //a variable from the file can be written only after it has been deleted, so it is already in m_PathsToDelete if it was staged
+        if(isFirstStaging)
+            m_PathsToDelete.push_back(stagedPath->first);
+        else
+            std::erase_if(m_VariablesToWrite, [&path](const Variable& variable) { return variable.GetPath() == path; });
+
+        return *this;
+    }
+
+    void ConfigFile::Transaction::Commit()
+    {
+        if(IsEmpty())
+            return;
+
+        const std::vector<std::string_view> pathsToDelete{ m_PathsToDelete.cbegin(), m_PathsToDelete.cend() };
+
+        const std::string configSource = ResourcesManager::ReceiveFileSource(m_ConfigFile->m_Path);
+
+        //ApplyChanges throws if the file doesn't have a variable to delete, so nothing is changed then
+        ResourcesManager::WriteToFile(m_ConfigFile->m_Path, Parser::ApplyChanges(configSource, m_VariablesToWrite, pathsToDelete), m_ConfigFile->m_SaveMode);
+
+        std::vector<Variable>& variables = m_ConfigFile->m_Variables;
+
+        if(!m_PathsToDelete.empty())
+        {
+            std::vector<bool> toDelete(variables.size(), false);
+
+            for(const std::string& path : m_PathsToDelete)
+                toDelete[m_ConfigFile->FindVariableIndex(path)] = true;
+
+            EraseVariables(variables, toDelete);
+        }
+
+        variables.reserve(variables.size() + m_VariablesToWrite.size());
+
+        for(Variable& variable : m_VariablesToWrite)
+            variables.push_back(std::move(variable));
+
+        //the variables are not in the order of the source anymore
+        m_ConfigFile->m_SourceSegments.reset();
+
+        m_ConfigFile->UpdateVariablesIndices();
+        m_ConfigFile->PublishSnapshot();
+
+        Rollback();
+    }
+    void ConfigFile::Transaction::Rollback() noexcept
+    {
+        m_VariablesToWrite.clear();
+        m_PathsToDelete.clear();
+        m_StagedPaths.clear();
+    }
+
+    bool ConfigFile::Transaction::IsEmpty() const noexcept
+    {
+        return m_VariablesToWrite.empty() && m_PathsToDelete.empty();
+    }
+
+    bool ConfigFile::Transaction::DoesVariableExist(const std::string_view& path) const
+    {
+        if(const auto stagedPath = m_StagedPaths.find(std::string{ path }); stagedPath != m_StagedPaths.cend())
+            return stagedPath->second;
+
+        return m_ConfigFile->FindVariableIndex(path) != EMPTY_VARIABLE_INDEX;
+    }
+}
+//ConfigFile::CompiledCache
+namespace GuelderResourcesManager
+{
+    namespace
+    {
+        //the file is read with memcpy, so the structs need no alignment and the file no padding
+        struct CompiledCacheHeader
+        {
+            static constexpr std::array<char, 8> MAGIC = { 'G', 'R', 'M', 'C', 'A', 'C', 'H', 'E' };
+            static constexpr uint32_t VERSION = 1;
+
+            std::array<char, 8> magic;
+            uint32_t version;
+            //the layout of the pre-parsed numbers depends on them
+            uint8_t longDoubleSize;
+            uint8_t isLittleEndian;
+            uint16_t reserved;
+            ConfigFile::CompiledCache::SourceKey sourceKey;
+            uint64_t variablesCount;
+            uint64_t stringsSize;
+        };
+        //offsets are into the strings, which follow the table
+        struct CompiledVariable
+        {
+            uint64_t pathOffset;
+            uint64_t valueOffset;
+            uint64_t valueSize;
+            uint32_t pathSize;
+            DataType type;
+            uint8_t isArray;
+            uint8_t hasCachedValue;
+            uint8_t reserved;
+            //the bytes of the C++ type of type, e.g. float for DataType::Float
+            std::array<unsigned char, 16> cachedValue;
+        };
+
+        static_assert(std::is_trivially_copyable_v<CompiledCacheHeader> && std::is_trivially_copyable_v<CompiledVariable>);
+        static_assert(sizeof(CompiledVariable) == 48 && sizeof(long double) <= sizeof(CompiledVariable::cachedValue));
+
+        bool IsCompatible(const CompiledCacheHeader& header) noexcept
+        {
+            return header.magic == CompiledCacheHeader::MAGIC && header.version == CompiledCacheHeader::VERSION && header.longDoubleSize == sizeof(long double)
+                && header.isLittleEndian == (std::endian::native == std::endian::little);
+        }
+
+        template<typename T, typename CachedValue>
+        CachedValue DecodeCachedNumber(const std::array<unsigned char, 16>& bytes) noexcept
+        {
+            T result;
+            std::memcpy(&result, bytes.data(), sizeof(T));
+
+            return result;
+        }
+        //returns std::monostate for the types that are never cached
+        template<typename CachedValue>
+        CachedValue DecodeCachedValue(DataType type, const std::array<unsigned char, 16>& bytes) noexcept
+        {
+            switch(type)
+            {
+            case DataType::Int: return DecodeCachedNumber<int, CachedValue>(bytes);
+            case DataType::UInt: return DecodeCachedNumber<unsigned int, CachedValue>(bytes);
+            case DataType::Long: return DecodeCachedNumber<long, CachedValue>(bytes);
+            case DataType::ULong: return DecodeCachedNumber<unsigned long, CachedValue>(bytes);
+            case DataType::LongLong: return DecodeCachedNumber<long long, CachedValue>(bytes);
+            case DataType::ULongLong: return DecodeCachedNumber<unsigned long long, CachedValue>(bytes);
+            case DataType::Short: return DecodeCachedNumber<short, CachedValue>(bytes);
+            case DataType::UShort: return DecodeCachedNumber<unsigned short, CachedValue>(bytes);
+            case DataType::Char: return DecodeCachedNumber<char, CachedValue>(bytes);
+            case DataType::UChar: return DecodeCachedNumber<unsigned char, CachedValue>(bytes);
+            case DataType::Float: return DecodeCachedNumber<float, CachedValue>(bytes);
+            case DataType::Double: return DecodeCachedNumber<double, CachedValue>(bytes);
+            case DataType::Bool: return bytes[0] != 0;
+            default: return {};
+            }
+        }
+    }
+
+    std::filesystem::path ConfigFile::CompiledCache::GetCachePath(const std::filesystem::path& configFilePath)
+    {
+        std::filesystem::path cachePath = configFilePath;
+        cachePath += ".compiled";
+
+        return cachePath;
+    }
+    ConfigFile::CompiledCache::SourceKey ConfigFile::CompiledCache::ReceiveSourceKey(const std::string_view& source, std::filesystem::file_time_type writeTime) noexcept
+    {
+        //the hash only has to notice the changes that keep the size and the write time
+        return { source.size(), static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(writeTime.time_since_epoch()).count()), HashSource(source) };
+    }
+
+    void ConfigFile::CompiledCache::Write(const std::filesystem::path& cachePath, const SourceKey& sourceKey, const std::vector<Variable>& variables)
+    {
+        std::vector<CompiledVariable> compiledVariables;
+        compiledVariables.reserve(variables.size());
+
+        std::string strings;
+
+        for(const Variable& variable : variables)
+        {
+            const std::string_view path = variable.GetPath();
+            const std::string_view value = variable.GetRawValue();
+
+            CompiledVariable compiledVariable{ strings.size(), strings.size() + path.size(), value.size(), static_cast<uint32_t>(path.size()), variable.GetType(), variable.IsArray(), 0, 0, {} };
+
+            std::visit([&compiledVariable](const auto& cachedValue)
+                {
+                    if constexpr(!std::is_same_v<std::decay_t<decltype(cachedValue)>, std::monostate>)
+                    {
+                        compiledVariable.hasCachedValue = 1;
+                        std::memcpy(compiledVariable.cachedValue.data(), &cachedValue, sizeof(cachedValue));
+                    }
+                }, variable.m_CachedValue);
+
+            strings.append(path);
+            strings.append(value);
+
+            compiledVariables.push_back(compiledVariable);
+        }
+
+        const CompiledCacheHeader header{ CompiledCacheHeader::MAGIC, CompiledCacheHeader::VERSION, sizeof(long double), std::endian::native == std::endian::little, 0, sourceKey, variables.size(), strings.size() };
+
+        std::string content;
+        content.reserve(sizeof(header) + compiledVariables.size() * sizeof(CompiledVariable) + strings.size());
+
+        content.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        content.append(reinterpret_cast<const char*>(compiledVariables.data()), compiledVariables.size() * sizeof(CompiledVariable));
+        content.append(strings);
+
+        ResourcesManager::WriteToFile(cachePath, content, SaveMode::Atomic);
+    }
+    std::optional<std::vector<Variable>> ConfigFile::CompiledCache::Read(const std::filesystem::path& cachePath, const SourceKey& sourceKey, StorageMode storageMode)
+    {
+        std::shared_ptr<const ResourcesManager::MappedFile> file;
+
+        try
+        {
+            file = std::make_shared<const ResourcesManager::MappedFile>(cachePath);
+        }
+        catch(const std::filesystem::filesystem_error&)
+        {
+            return std::nullopt;
+        }
+
+        const std::string_view data = file->GetSource();
+
+        CompiledCacheHeader header;
+
+        if(data.size() < sizeof(header))
+            return std::nullopt;
+
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        if(!IsCompatible(header) || header.sourceKey != sourceKey)
+            return std::nullopt;
+
+        const size_t tableSize = data.size() - sizeof(header);
+
+        if(header.variablesCount > tableSize / sizeof(CompiledVariable) || tableSize - header.variablesCount * sizeof(CompiledVariable) != header.stringsSize)
+            return std::nullopt;
+
+        const char* compiledVariablesData = data.data() + sizeof(header);
+        const std::string_view strings = data.substr(sizeof(header) + header.variablesCount * sizeof(CompiledVariable));
+
+        //View variables keep the whole mapping alive
+        const std::shared_ptr<const void> storage = storageMode == StorageMode::View ? file : nullptr;
+
+        std::vector<Variable> variables;
+        variables.reserve(header.variablesCount);
+
+        for(size_t i = 0; i < header.variablesCount; i++)
+        {
+            CompiledVariable compiledVariable;
+            std::memcpy(&compiledVariable, compiledVariablesData + i * sizeof(CompiledVariable), sizeof(compiledVariable));
+
+            if(compiledVariable.pathOffset > strings.size() || compiledVariable.pathSize > strings.size() - compiledVariable.pathOffset
+                || compiledVariable.valueOffset > strings.size() || compiledVariable.valueSize > strings.size() - compiledVariable.valueOffset
+                || compiledVariable.type > DataType::String)
+                return std::nullopt;
+
+            Variable::CachedValue cachedValue = compiledVariable.hasCachedValue ? DecodeCachedValue<Variable::CachedValue>(compiledVariable.type, compiledVariable.cachedValue) : Variable::CachedValue{};
+
+            variables.push_back(Variable{ strings.substr(compiledVariable.pathOffset, compiledVariable.pathSize), strings.substr(compiledVariable.valueOffset, compiledVariable.valueSize),
+                compiledVariable.type, compiledVariable.isArray != 0, std::move(cachedValue), storage });
+        }
+
+        return variables;
+    }
+}
+//ConfigFile::Parser is garbage
+namespace GuelderResourcesManager
+{
+    ConfigFile::Parser::VariableIndicesInfo& ConfigFile::Parser::VariableIndicesInfo::operator+=(index offset)
+    {
+        type += offset;
+        equals += offset;
+        name += offset;
+        value += offset;
+        semicolon += offset;
+
+        return *this;
+    }
+
+    bool ConfigFile::Parser::IsFullSubstringSame(const std::string_view& string, ConfigFile::Parser::index stringIndexPosition, const std::string_view& substring)
+    {
+        bool result = true;
+        for(index k = 0; stringIndexPosition < string.size() && k < substring.size(); stringIndexPosition++, k++)
+            if(string[stringIndexPosition] != substring[k])
+            {
+                result = false;
+                break;
+            }
+
+        if(result && stringIndexPosition > 0)
+            stringIndexPosition--;
+
+        return result;
+    }
+
+    namespace
+    {
+        using StructuralBlock = ConfigFile::Parser::StructuralBlock;
+
+        constexpr size_t STRUCTURAL_BLOCK_SIZE = 64;
+
+        //the chars of a block before the escapes and the words are found
+        struct CharMasks
+        {
+            uint64_t structurals;
+            uint64_t quotes;
+            uint64_t specialCharSigns;
+            uint64_t commentBegins;
+            uint64_t newlines;
+            uint64_t variableChars;
+        };
+
+        enum CharClass : uint8_t
+        {
+            STRUCTURAL_CHAR = 1 << 0,
+            QUOTE_CHAR = 1 << 1,
+            SPECIAL_CHAR_SIGN_CHAR = 1 << 2,
+            COMMENT_BEGIN_CHAR = 1 << 3,
+            NEWLINE_CHAR = 1 << 4,
+            VARIABLE_CHAR = 1 << 5
+        };
+
+        constexpr std::array<uint8_t, 256> CHAR_CLASSES = []
+            {
+                using Parser = ConfigFile::Parser;
+
+                std::array<uint8_t, 256> charClasses{};
+
+                for(const char ch : { Parser::SCOPE_OPEN, Parser::SCOPE_CLOSE, Parser::EQUALS, Parser::SEMICOLON, Parser::ARRAY_ITEMS_SEPARATOR })
+                    charClasses[static_cast<uint8_t>(ch)] |= STRUCTURAL_CHAR;
+
+                charClasses[static_cast<uint8_t>(Parser::VARIABLE_VALUE_SCOPE)] |= QUOTE_CHAR;
+                charClasses[static_cast<uint8_t>(Parser::SPECIAL_CHAR_SIGN)] |= SPECIAL_CHAR_SIGN_CHAR;
+                charClasses[static_cast<uint8_t>(Parser::COMMENT_SCOPE_LINE[0])] |= COMMENT_BEGIN_CHAR;
+                charClasses[static_cast<uint8_t>(Parser::NEWLINE)] |= NEWLINE_CHAR;
+
+                //the same as Variable::IsValidVariableChar in the "C" locale
+                for(size_t ch = 0; ch < charClasses.size(); ch++)
+                    if((ch >= '0' && ch <= '9') || (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') || ch == '_')
+                        charClasses[ch] |= VARIABLE_CHAR;
+
+                return charClasses;
+            }();
+
+        CharMasks ScanBlockScalar(const char* block) noexcept
+        {
+            CharMasks masks{};
+
+            for(size_t i = 0; i < STRUCTURAL_BLOCK_SIZE; i++)
+            {
+                const uint64_t charClass = CHAR_CLASSES[static_cast<uint8_t>(block[i])];
+
+                masks.structurals |= (charClass & 1) << i;
+                masks.quotes |= (charClass >> 1 & 1) << i;
+                masks.specialCharSigns |= (charClass >> 2 & 1) << i;
+                masks.commentBegins |= (charClass >> 3 & 1) << i;
+                masks.newlines |= (charClass >> 4 & 1) << i;
+                masks.variableChars |= (charClass >> 5 & 1) << i;
+            }
+
+            return masks;
+        }
+
+#ifdef GE_X86_64
+        CharMasks ScanBlockSSE2(const char* block) noexcept
+        {
+            using Parser = ConfigFile::Parser;
+
+            constexpr size_t VECTOR_SIZE = sizeof(__m128i);
+
+            CharMasks masks{};
+
+            for(size_t offset = 0; offset < STRUCTURAL_BLOCK_SIZE; offset += VECTOR_SIZE)
+            {
+                const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + offset));
+
+                const auto equals = [&chars](char ch) { return _mm_cmpeq_epi8(chars, _mm_set1_epi8(ch)); };
+                //unsigned, the chars are compared to their clamped values
+                const auto isInRange = [](const __m128i& value, char first, char last)
+                    {
+                        return _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(value, _mm_set1_epi8(first)), value), _mm_cmpeq_epi8(_mm_min_epu8(value, _mm_set1_epi8(last)), value));
+                    };
+                const auto toMask = [offset](const __m128i& matches) { return static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(matches))) << offset; };
+
+                const __m128i structurals = _mm_or_si128(_mm_or_si128(equals(Parser::SCOPE_OPEN), equals(Parser::SCOPE_CLOSE)), _mm_or_si128(_mm_or_si128(equals(Parser::EQUALS), equals(Parser::SEMICOLON)), equals(Parser::ARRAY_ITEMS_SEPARATOR)));
+                //the lower case letters are the upper case ones with 0x20
+                const __m128i variableChars = _mm_or_si128(_mm_or_si128(isInRange(chars, '0', '9'), isInRange(_mm_or_si128(chars, _mm_set1_epi8(0x20)), 'a', 'z')), equals('_'));
+
+                masks.structurals |= toMask(structurals);
+                masks.quotes |= toMask(equals(Parser::VARIABLE_VALUE_SCOPE));
+                masks.specialCharSigns |= toMask(equals(Parser::SPECIAL_CHAR_SIGN));
+                masks.commentBegins |= toMask(equals(Parser::COMMENT_SCOPE_LINE[0]));
+                masks.newlines |= toMask(equals(Parser::NEWLINE));
+                masks.variableChars |= toMask(variableChars);
+            }
+
+            return masks;
+        }
+
+        //the same as in ScanBlockSSE2, without lambdas, as they wouldn't be compiled for AVX2
+        GE_TARGET_AVX2 __m256i EqualsAVX2(const __m256i& chars, char ch) noexcept
+        {
+            return _mm256_cmpeq_epi8(chars, _mm256_set1_epi8(ch));
+        }
+        GE_TARGET_AVX2 __m256i IsInRangeAVX2(const __m256i& value, char first, char last) noexcept
+        {
+            return _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(value, _mm256_set1_epi8(first)), value), _mm256_cmpeq_epi8(_mm256_min_epu8(value, _mm256_set1_epi8(last)), value));
+        }
+        GE_TARGET_AVX2 uint64_t ToMaskAVX2(const __m256i& matches, size_t offset) noexcept
+        {
+            return static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(matches))) << offset;
+        }
+        GE_TARGET_AVX2 CharMasks ScanBlockAVX2(const char* block) noexcept
+        {
+            using Parser = ConfigFile::Parser;
+
+            constexpr size_t VECTOR_SIZE = sizeof(__m256i);
+
+            CharMasks masks{};
+
+            for(size_t offset = 0; offset < STRUCTURAL_BLOCK_SIZE; offset += VECTOR_SIZE)
+            {
+                const __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + offset));
+
+                const __m256i structurals = _mm256_or_si256(_mm256_or_si256(EqualsAVX2(chars, Parser::SCOPE_OPEN), EqualsAVX2(chars, Parser::SCOPE_CLOSE)),
+                    _mm256_or_si256(_mm256_or_si256(EqualsAVX2(chars, Parser::EQUALS), EqualsAVX2(chars, Parser::SEMICOLON)), EqualsAVX2(chars, Parser::ARRAY_ITEMS_SEPARATOR)));
+                const __m256i variableChars = _mm256_or_si256(_mm256_or_si256(IsInRangeAVX2(chars, '0', '9'), IsInRangeAVX2(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), 'a', 'z')), EqualsAVX2(chars, '_'));
+
+                masks.structurals |= ToMaskAVX2(structurals, offset);
+                masks.quotes |= ToMaskAVX2(EqualsAVX2(chars, Parser::VARIABLE_VALUE_SCOPE), offset);
+                masks.specialCharSigns |= ToMaskAVX2(EqualsAVX2(chars, Parser::SPECIAL_CHAR_SIGN), offset);
+                masks.commentBegins |= ToMaskAVX2(EqualsAVX2(chars, Parser::COMMENT_SCOPE_LINE[0]), offset);
+                masks.newlines |= ToMaskAVX2(EqualsAVX2(chars, Parser::NEWLINE), offset);
+                masks.variableChars |= ToMaskAVX2(variableChars, offset);
+            }
+
+            return masks;
+        }
+#endif
+
+        //the chars after an odd amount of SPECIAL_CHAR_SIGNs, without a loop, the way simdjson finds them.
+        //endsWithOddSequence is carried from the previous block to the next one
+        uint64_t ReceiveEscapedChars(uint64_t specialCharSigns, uint64_t& endsWithOddSequence) noexcept
+        {
+            constexpr uint64_t EVEN_BITS = 0x5555555555555555;
+            constexpr uint64_t ODD_BITS = ~EVEN_BITS;
+
+            const uint64_t sequenceBegins = specialCharSigns & ~(specialCharSigns << 1);
+            //a sequence which continues from the previous block starts on the other parity
+            const uint64_t evenBeginMask = EVEN_BITS ^ endsWithOddSequence;
+            const uint64_t evenBegins = sequenceBegins & evenBeginMask;
+            const uint64_t oddBegins = sequenceBegins & ~evenBeginMask;
+
+            //adding the beginning of a sequence carries past its end
+            const uint64_t evenCarries = specialCharSigns + evenBegins;
+            uint64_t oddCarries = specialCharSigns + oddBegins;
+            const bool doesEndWithOddSequence = oddCarries < specialCharSigns;
+
+            oddCarries |= endsWithOddSequence;
+            endsWithOddSequence = doesEndWithOddSequence;
+
+            const uint64_t evenCarryEnds = evenCarries & ~specialCharSigns;
+            const uint64_t oddCarryEnds = oddCarries & ~specialCharSigns;
+
+            return (evenCarryEnds & ODD_BITS) | (oddCarryEnds & EVEN_BITS);
+        }
+
+        //returns scopeSize if receiveBits sets no bit of the chars from from on
+        template<typename ReceiveBits>
+        ConfigFile::Parser::index FindNextChar(const std::vector<StructuralBlock>& blocks, ConfigFile::Parser::index from, ConfigFile::Parser::index scopeSize, ReceiveBits&& receiveBits) noexcept
+        {
+            size_t block = from / STRUCTURAL_BLOCK_SIZE;
+
+            if(block >= blocks.size())
+                return scopeSize;
+
+            uint64_t bits = receiveBits(blocks[block]) & (~uint64_t{ 0 } << (from % STRUCTURAL_BLOCK_SIZE));
+
+            while(bits == 0)
+            {
+                if(++block == blocks.size())
+                    return scopeSize;
+
+                bits = receiveBits(blocks[block]);
+            }
+
+            return std::min<ConfigFile::Parser::index>(block * STRUCTURAL_BLOCK_SIZE + std::countr_zero(bits), scopeSize);
+        }
+        //the chars whose bit is set in Mask, or unset if IS_INVERTED
+        template<uint64_t StructuralBlock::* Mask, bool IS_INVERTED = false>
+        ConfigFile::Parser::index FindNextChar(const std::vector<StructuralBlock>& blocks, ConfigFile::Parser::index from, ConfigFile::Parser::index scopeSize) noexcept
+        {
+            return FindNextChar(blocks, from, scopeSize, [](const StructuralBlock& block) { return IS_INVERTED ? ~(block.*Mask) : block.*Mask; });
+        }
+    }
+
+    ConfigFile::Parser::InstructionSet ConfigFile::Parser::ReceiveInstructionSet() noexcept
+    {
+        static const InstructionSet instructionSet = []
+            {
+#ifdef GE_X86_64
+#ifdef _MSC_VER
+                int info[4];
+
+                //AVX has to be enabled by the OS as well
+                __cpuid(info, 1);
+                const bool hasAVX = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6;
+
+                __cpuidex(info, 7, 0);
+                const bool hasAVX2 = hasAVX && (info[1] & (1 << 5));
+#else
+                __builtin_cpu_init();
+                const bool hasAVX2 = __builtin_cpu_supports("avx2");
+#endif
+                return hasAVX2 ? InstructionSet::AVX2 : InstructionSet::SSE2;
+#else
+                return InstructionSet::Scalar;
+#endif
+            }();
+
+        return instructionSet;
+    }
+    std::vector<ConfigFile::Parser::StructuralBlock> ConfigFile::Parser::ScanStructure(const std::string_view& scope, InstructionSet instructionSet)
+    {
+        std::vector<StructuralBlock> blocks;
+
+        ScanStructure(scope, blocks, instructionSet);
+
+        return blocks;
+    }
+    void ConfigFile::Parser::ScanStructure(const std::string_view& scope, std::vector<StructuralBlock>& blocks, InstructionSet instructionSet)
+    {
+        //every instruction set includes the previous ones
+        if(instructionSet > ReceiveInstructionSet())
+            throw std::invalid_argument{ "The instruction set is not supported by the CPU" };
+
+        CharMasks(*scanBlock)(const char*) noexcept = ScanBlockScalar;
+
+#ifdef GE_X86_64
+        if(instructionSet == InstructionSet::AVX2)
+            scanBlock = ScanBlockAVX2;
+        else if(instructionSet == InstructionSet::SSE2)
+            scanBlock = ScanBlockSSE2;
+#endif
+
+        const size_t blocksCount = (scope.size() + STRUCTURAL_BLOCK_SIZE - 1) / STRUCTURAL_BLOCK_SIZE;
+
+        //every block is overwritten
+        blocks.resize(blocksCount);
+
+        uint64_t endsWithOddSequence = 0;
+        uint64_t endsWithVariableChar = 0;
+
+        for(size_t block = 0; block < blocksCount; block++)
+        {
+            const size_t offset = block * STRUCTURAL_BLOCK_SIZE;
+            const char* chars = scope.data() + offset;
+
+            //the last block is copied, so nothing is read past the end of scope
+            char lastBlock[STRUCTURAL_BLOCK_SIZE] = {};
+            if(scope.size() - offset < STRUCTURAL_BLOCK_SIZE)
+            {
+                std::memcpy(lastBlock, chars, scope.size() - offset);
+                chars = lastBlock;
+            }
+
+            const CharMasks masks = scanBlock(chars);
+
+            const uint64_t escapedChars = ReceiveEscapedChars(masks.specialCharSigns, endsWithOddSequence);
+            const uint64_t wordBegins = masks.variableChars & ~(masks.variableChars << 1 | endsWithVariableChar);
+
+            endsWithVariableChar = masks.variableChars >> (STRUCTURAL_BLOCK_SIZE - 1);
+
+            blocks[block] =
+            {
+                masks.structurals | masks.quotes | masks.commentBegins | wordBegins,
+                masks.quotes & ~escapedChars,
+                masks.newlines,
+                masks.variableChars
+            };
+        }
+    }
+
+    std::vector<ConfigFile::Parser::Token> ConfigFile::Parser::Tokenize(const std::string_view& scope)
+    {
+        std::vector<Token> tokens;
+        std::vector<StructuralBlock> blocks;
+
+        Tokenize(scope, tokens, blocks);
+
+        return tokens;
+    }
+    void ConfigFile::Parser::Tokenize(const std::string_view& scope, std::vector<Token>& tokens, std::vector<StructuralBlock>& blocks)
+    {
+        tokens.clear();
+        tokens.reserve(scope.size() / 4);
+
+        ScanStructure(scope, blocks);
+
+        //the keyword is recognized only at the beginning of a statement, so "ns" inside a variable name stays an identifier
+        bool isStatementBegin = true;
+
+        const index size = scope.size();
+
+        //whitespaces and the other chars that are not tokens are jumped over
+        for(index i = FindNextChar<&StructuralBlock::events>(blocks, 0, size); i < size; i = FindNextChar<&StructuralBlock::events>(blocks, i, size))
+        {
+            const char currentChar = scope[i];
+
+            if(currentChar == COMMENT_SCOPE_LINE[0] && IsFullSubstringSame(scope, i, COMMENT_SCOPE_LINE))
+            {
+                const index commentEnd = FindNextChar<&StructuralBlock::newlines>(blocks, i, size);
+
+                tokens.push_back({ TokenType::Comment, { i, commentEnd - 1 } });
+
+                i = commentEnd;
+            }
+            else if(currentChar == VARIABLE_VALUE_SCOPE)
+            {
+                index valueEnd = FindNextChar<&StructuralBlock::closingQuotes>(blocks, i + 1, size);
+
+                if(valueEnd >= size)
+                    valueEnd = size - 1;
+
+                tokens.push_back({ TokenType::String, { i, valueEnd } });
+
+                isStatementBegin = false;
+
+                i = valueEnd + 1;
+            }
+            else if(Variable::IsValidVariableChar(currentChar))
+            {
+                index wordBegin = i;
+
+                if(isStatementBegin && IsFullSubstringSame(scope, i, NAMESPACE_KEYWORD))
+                {
+                    tokens.push_back({ TokenType::Keyword, { i, i + static_cast<index>(NAMESPACE_KEYWORD.size()) - 1 } });
+
+                    wordBegin += NAMESPACE_KEYWORD.size();
+                }
+
+                const index wordEnd = FindNextChar<&StructuralBlock::variableChars, true>(blocks, wordBegin, size);
+
+                if(wordEnd > wordBegin)
+                    tokens.push_back({ TokenType::Identifier, { wordBegin, wordEnd - 1 } });
+
+                isStatementBegin = false;
+
+                i = std::max(wordEnd, wordBegin);
+            }
+            else
+            {
+                TokenType type = TokenType::Invalid;
+
+                switch(currentChar)
+                {
+                case SCOPE_OPEN: type = TokenType::ScopeOpen; break;
+                case SCOPE_CLOSE: type = TokenType::ScopeClose; break;
+                case EQUALS: type = TokenType::Equals; break;
+                case SEMICOLON: type = TokenType::Semicolon; break;
+                case ARRAY_ITEMS_SEPARATOR: type = TokenType::ArrayItemsSeparator; break;
+                default: break;
+                }
+
+                if(type != TokenType::Invalid)
+                {
+                    tokens.push_back({ type, { i, i } });
+
+                    isStatementBegin = type == TokenType::ScopeOpen || type == TokenType::ScopeClose || type == TokenType::Semicolon;
+                }
+
+                i++;
+            }
+        }
+    }
+    std::vector<ConfigFile::Parser::StringRange> ConfigFile::Parser::SplitTopLevelScopes(const std::string_view& scope)
+    {
+        //comments and strings are skipped the same way as in Tokenize, so the ranges are split between tokens
+        std::vector<StringRange> ranges;
+
+        const index size = scope.size();
+
+        const std::vector<StructuralBlock> blocks = ScanStructure(scope);
+
+        //the beginnings of words are not needed here
+        const auto receiveEvents = [](const StructuralBlock& block) { return block.events & ~block.variableChars; };
+
+        index rangeBegin = 0;
+        index scopesOpened = 0;
+
+        for(index i = FindNextChar(blocks, 0, size, receiveEvents); i < size; i = FindNextChar(blocks, i + 1, size, receiveEvents))
+        {
+            const char currentChar = scope[i];
+
+            if(currentChar == COMMENT_SCOPE_LINE[0] && IsFullSubstringSame(scope, i, COMMENT_SCOPE_LINE))
+            {
+                const index commentEnd = FindNextChar<&StructuralBlock::newlines>(blocks, i, size);
+
+                if(commentEnd == size)
+                    break;
+
+                i = commentEnd;
+            }
+            else if(currentChar == VARIABLE_VALUE_SCOPE)
+                i = FindNextChar<&StructuralBlock::closingQuotes>(blocks, i + 1, size);
+            else if(currentChar == SCOPE_OPEN)
+                scopesOpened++;
+            //an extra SCOPE_CLOSE ends a range as well
+            else if(currentChar == SCOPE_CLOSE && --scopesOpened <= 0)
+            {
+                //the SEMICOLON after an array belongs to the same statement
+                index semicolon = i + 1;
+                while(semicolon < size && std::isspace(static_cast<unsigned char>(scope[semicolon])))
+                    semicolon++;
+
+                if(semicolon < size && scope[semicolon] == SEMICOLON)
+                    i = semicolon;
+
+                ranges.push_back({ rangeBegin, i });
+
+                rangeBegin = i + 1;
+                scopesOpened = 0;
+            }
+        }
+
+        if(rangeBegin < size)
+            ranges.push_back({ rangeBegin, size - 1 });
+
+        return ranges;
+    }
+
+    namespace
+    {
+        //returns tokens.size() if nothing is found
+        size_t FindNextToken(const std::vector<ConfigFile::Parser::Token>& tokens, size_t from, ConfigFile::Parser::TokenType type) noexcept
+        {
+            for(; from < tokens.size(); from++)
+                if(tokens[from].type == type)
+                    break;
+
+            return from;
+        }
+        //the same, but stops at the first token that is not a comment
+        size_t FindNextSignificantToken(const std::vector<ConfigFile::Parser::Token>& tokens, size_t from) noexcept
+        {
+            for(; from < tokens.size(); from++)
+                if(tokens[from].type != ConfigFile::Parser::TokenType::Comment)
+                    break;
+
+            return from;
+        }
+    }
+
+    void ConfigFile::Parser::ProcessNamespace(std::vector<Variable>& variables, std::string& path, const std::string_view& scope)
+    {
+        ProcessTokens(variables, path, scope, Tokenize(scope));
+    }
+
+    bool ConfigFile::Parser::ProcessTokens(std::vector<Variable>& variables, std::string& path, const std::string_view& scope, const std::vector<Token>& tokens, const std::shared_ptr<ViewStorage>& viewStorage)
+    {
+        //ALL indices are INCLUSIVE
+
+        //path sizes before entering each opened namespace, so leaving a namespace doesn't rescan the path
+        std::vector<size_t> pathSizes;
+
+        const size_t tokensCount = tokens.size();
+
+        auto findNext = [&tokens](size_t from, TokenType type) { return FindNextToken(tokens, from, type); };
+        auto nextSignificant = [&tokens](size_t from) { return FindNextSignificantToken(tokens, from); };
+
+        for(size_t t = 0; t < tokensCount; t++)
+        {
+            const Token& token = tokens[t];
+
+            if(token.type == TokenType::Keyword)
+            {
+                const size_t nameToken = findNext(t + 1, TokenType::Identifier);
+                const size_t scopeOpenToken = findNext(nameToken, TokenType::ScopeOpen);
+
+                if(scopeOpenToken == tokensCount)
+                    return false;
+
+                pathSizes.push_back(path.size());
+
+                path += tokens[nameToken].range.GetSubstring<std::string_view>(scope);
+                path += PATH_SEPARATOR;
+
+                t = scopeOpenToken;
+            }
+            else if(token.type == TokenType::ScopeClose)
+            {
+                if(!pathSizes.empty())
+                {
+                    path.resize(pathSizes.back());
+                    pathSizes.pop_back();
+                }
+            }
+            else if(token.type == TokenType::Identifier)
+            {
+                const std::string_view variableType = token.range.GetSubstring<std::string_view>(scope);
+
+                const size_t nameToken = findNext(t + 1, TokenType::Identifier);
+                const size_t equalsToken = findNext(nameToken, TokenType::Equals);
+                const size_t valueToken = nextSignificant(equalsToken + 1);
+
+                if(valueToken >= tokensCount)
+                    return false;
+
+                const bool isArray = tokens[valueToken].type == TokenType::ScopeOpen;
+
+                size_t valueEndToken = valueToken;
+                std::string_view variableValueRaw;
+
+                if(isArray)
+                {
+                    valueEndToken = findNext(valueToken + 1, TokenType::ScopeClose);
+
+                    if(valueEndToken == tokensCount)
+                        return false;
+
+                    const StringRange arrayRange{ tokens[valueToken].range.begin, tokens[valueEndToken].range.end };
+
+                    //empty array is the same as an empty value
+                    if(arrayRange.end - arrayRange.begin > 1)
+                        variableValueRaw = arrayRange.GetSubstring<std::string_view>(scope);
+                }
+                else if(tokens[valueToken].type == TokenType::String)
+                {
+                    const StringRange& stringRange = tokens[valueToken].range;
+
+                    if(stringRange.end - stringRange.begin > 1)
+                        variableValueRaw = StringRange{ stringRange.begin + 1, stringRange.end - 1 }.GetSubstring<std::string_view>(scope);
+                }
+                else
+                    continue;
+
+                const std::string_view variableName = tokens[nameToken].range.GetSubstring<std::string_view>(scope);
+
+                //arrays keep their special chars
+                const bool hasSpecialChars = !isArray && variableValueRaw.find(SPECIAL_CHAR_SIGN) != std::string_view::npos;
+
+                if(viewStorage)
+                {
+                    const std::string_view variableValueView = hasSpecialChars ? viewStorage->InternWithoutSpecialChars(variableValueRaw) : variableValueRaw;
+
+                    variables.emplace_back(viewStorage->Intern(path, variableName), variableValueView, StringToDataType(variableType), isArray, viewStorage, &viewStorage->pool);
+
+                    t = findNext(valueEndToken + 1, TokenType::Semicolon);
+
+                    if(t == tokensCount)
+                        return false;
+
+                    continue;
+                }
+
+                std::string variableValue = hasSpecialChars ? RemoveSpecialChars(variableValueRaw) : std::string{ variableValueRaw };
+
+                //the path is written right into the block of the variable. It is not taken from a shared arena like the views above,
+                //because a copied variable must not keep the strings of the whole file alive after it is changed by Reopen or taken out of the ConfigFile
+                variables.push_back(Variable{ Variable::ReceiveOwnedStrings(path, variableName, std::move(variableValue)), StringToDataType(variableType), isArray });
+
+                t = findNext(valueEndToken + 1, TokenType::Semicolon);
+
+                if(t == tokensCount)
+                    return false;
+            }
+        }
+
+        return pathSizes.empty();
+    }
+
+    void ConfigFile::Parser::ReceiveScopeLayout(const std::string_view& scope, const std::vector<Token>& tokens, std::unordered_map<std::string, StringRange>& namespaceScopes, std::unordered_map<std::string, StringRange>& variableRanges)
+    {
+        //the same walk as in ProcessTokens, but only the ranges are saved
+
+        //path sizes and SCOPE_OPEN indices of the opened namespaces
+        std::vector<std::pair<size_t, index>> openedNamespaces;
+        std::string path;
+
+        const size_t tokensCount = tokens.size();
+
+        auto findNext = [&tokens](size_t from, TokenType type) { return FindNextToken(tokens, from, type); };
+
+        for(size_t t = 0; t < tokensCount; t++)
+        {
+            const Token& token = tokens[t];
+
+            if(token.type == TokenType::Keyword)
+            {
+                const size_t nameToken = findNext(t + 1, TokenType::Identifier);
+                const size_t scopeOpenToken = findNext(nameToken, TokenType::ScopeOpen);
+
+                if(scopeOpenToken == tokensCount)
+                    break;
+
+                openedNamespaces.emplace_back(path.size(), tokens[scopeOpenToken].range.begin);
+
+                path += tokens[nameToken].range.GetSubstring<std::string_view>(scope);
+                path += PATH_SEPARATOR;
+
+                t = scopeOpenToken;
+            }
+            else if(token.type == TokenType::ScopeClose)
+            {
+                if(!openedNamespaces.empty())
+                {
+                    const auto [pathSize, scopeOpen] = openedNamespaces.back();
+
+                    namespaceScopes.try_emplace(path.substr(0, path.size() - 1), scopeOpen, token.range.begin);
+
+                    path.resize(pathSize);
+                    openedNamespaces.pop_back();
+                }
+            }
+            else if(token.type == TokenType::Identifier)
+            {
+                const size_t nameToken = findNext(t + 1, TokenType::Identifier);
+                const size_t equalsToken = findNext(nameToken, TokenType::Equals);
+                const size_t valueToken = FindNextSignificantToken(tokens, equalsToken + 1);
+
+                if(valueToken >= tokensCount)
+                    break;
+
+                size_t valueEndToken = valueToken;
+
+                if(tokens[valueToken].type == TokenType::ScopeOpen)
+                {
+                    valueEndToken = findNext(valueToken + 1, TokenType::ScopeClose);
+
+                    if(valueEndToken == tokensCount)
+                        break;
+                }
+                else if(tokens[valueToken].type != TokenType::String)
+                    continue;
+
+                const size_t semicolonToken = findNext(valueEndToken + 1, TokenType::Semicolon);
+
+                std::string variablePath = path;
+                variablePath += tokens[nameToken].range.GetSubstring<std::string_view>(scope);
+
+                variableRanges.try_emplace(std::move(variablePath), token.range.begin, tokens[semicolonToken < tokensCount ? semicolonToken : valueEndToken].range.end);
+
+                t = semicolonToken;
+            }
+        }
+    }
+
+    namespace
+    {
+        ConfigFile::Parser::index ReceiveBeginIndex(const ConfigFile::Parser::NamespaceIndicesInfo& namespaceInfo) noexcept
+        {
+            return namespaceInfo.keyword.begin;
+        }
+        ConfigFile::Parser::index ReceiveBeginIndex(const ConfigFile::Parser::VariableIndicesInfo& variableInfo) noexcept
+        {
+            return variableInfo.type.begin;
+        }
+        ConfigFile::Parser::index ReceiveEndIndex(const ConfigFile::Parser::NamespaceIndicesInfo& namespaceInfo) noexcept
+        {
+            return namespaceInfo.scope.end;
+        }
+        ConfigFile::Parser::index ReceiveEndIndex(const ConfigFile::Parser::VariableIndicesInfo& variableInfo) noexcept
+        {
+            return variableInfo.semicolon;
+        }
+
+        //if a path repeats, the one that is earlier in the source is kept. Returns false if the path repeats
+        template<typename Map, typename IndicesInfo>
+        bool EmplaceFirst(Map& map, std::string&& path, const IndicesInfo& indicesInfo)
+        {
+            const auto [found, isInserted] = map.try_emplace(std::move(path), indicesInfo);
+
+            if(!isInserted && ReceiveBeginIndex(indicesInfo) < ReceiveBeginIndex(found->second))
+                found->second = indicesInfo;
+
+            return isInserted;
+        }
+    }
+
+    ConfigFile::Parser::SourceIndex::SourceIndex(const std::string_view& scope)
+    {
+        Add(scope, 0, {});
+    }
+
+    const ConfigFile::Parser::NamespaceIndicesInfo& ConfigFile::Parser::SourceIndex::FindNamespace(const std::string_view& path) const
+    {
+        const auto found = m_Namespaces.find(path);
+
+        if(found == m_Namespaces.cend())
+            throw std::out_of_range{ "Failed to find namespace" };
+
+        return found->second;
+    }
+    const ConfigFile::Parser::VariableIndicesInfo& ConfigFile::Parser::SourceIndex::FindVariableInfo(const std::string_view& path) const
+    {
+        const auto found = m_Variables.find(path);
+
+        if(found == m_Variables.cend())
+            throw std::out_of_range{ "failed to find variable" };
+
+        return found->second;
+    }
+
+    bool ConfigFile::Parser::SourceIndex::DoesNamespaceExist(const std::string_view& path) const
+    {
+        return m_Namespaces.contains(path);
+    }
+    bool ConfigFile::Parser::SourceIndex::DoesVariableExist(const std::string_view& path) const
+    {
+        return m_Variables.contains(path);
+    }
+
+    size_t ConfigFile::Parser::SourceIndex::PathHash::operator()(const std::string_view& path) const noexcept
+    {
+        return std::hash<std::string_view>{}(path);
+    }
+
+    void ConfigFile::Parser::SourceIndex::Add(const std::string_view& scope, index offset, std::string path)
+    {
+        //the same walk as in ReceiveScopeLayout, but all the indices are saved, the way ReceiveNamespaceInfo and ReceiveVariableInfo return them
+
+        const std::vector<Token> tokens = Tokenize(scope);
+        const size_t tokensCount = tokens.size();
+
+        auto findNext = [&tokens](size_t from, TokenType type) { return FindNextToken(tokens, from, type); };
+
+        //path sizes before entering the opened namespaces and their indices, whose scope ends are not known yet
+        std::vector<std::pair<size_t, NamespaceIndicesInfo>> openedNamespaces;
+
+        for(size_t t = 0; t < tokensCount; t++)
+        {
+            const Token& token = tokens[t];
+
+            if(token.type == TokenType::Keyword)
+            {
+                const size_t nameToken = findNext(t + 1, TokenType::Identifier);
+                const size_t scopeOpenToken = findNext(nameToken, TokenType::ScopeOpen);
+
+                if(scopeOpenToken == tokensCount)
+                    break;
+
+                const index scopeOpen = tokens[scopeOpenToken].range.begin;
+
+                openedNamespaces.emplace_back(path.size(), NamespaceIndicesInfo{ token.range, tokens[nameToken].range, { scopeOpen, scopeOpen } });
+
+                path += tokens[nameToken].range.GetSubstring<std::string_view>(scope);
+                path += PATH_SEPARATOR;
+
+                t = scopeOpenToken;
+            }
+            else if(token.type == TokenType::ScopeClose)
+            {
+                if(!openedNamespaces.empty())
+                {
+                    auto& [pathSize, namespaceInfo] = openedNamespaces.back();
+
+                    namespaceInfo.scope.end = token.range.begin;
+                    namespaceInfo += offset;
+
+                    if(!EmplaceFirst(m_Namespaces, path.substr(0, path.size() - 1), namespaceInfo))
+                        m_HasRepeatedPaths = true;
+
+                    path.resize(pathSize);
+                    openedNamespaces.pop_back();
+                }
+            }
+            else if(token.type == TokenType::Identifier)
+            {
+                const size_t nameToken = findNext(t + 1, TokenType::Identifier);
+                const size_t equalsToken = findNext(nameToken, TokenType::Equals);
+                const size_t valueToken = FindNextSignificantToken(tokens, equalsToken + 1);
+
+                if(valueToken >= tokensCount)
+                    break;
+
+                size_t valueEndToken = valueToken;
+                //an empty value has no indices
+                StringRange value;
+
+                if(tokens[valueToken].type == TokenType::ScopeOpen)
+                {
+                    valueEndToken = findNext(valueToken + 1, TokenType::ScopeClose);
+
+                    if(valueEndToken == tokensCount)
+                        break;
+
+                    const index scopeOpen = tokens[valueToken].range.begin;
+                    const index scopeClose = tokens[valueEndToken].range.begin;
+
+                    //braces are included
+                    if(scopeClose - scopeOpen > 1)
+                        value = { scopeOpen + offset, scopeClose + offset };
+                }
+                else if(tokens[valueToken].type == TokenType::String)
+                {
+                    const StringRange& string = tokens[valueToken].range;
+
+                    //VARIABLE_VALUE_SCOPEs are not included
+                    if(string.end - string.begin > 1)
+                        value = { string.begin + 1 + offset, string.end - 1 + offset };
+                }
+                else
+                    continue;
+
+                const size_t semicolonToken = findNext(valueEndToken + 1, TokenType::Semicolon);
+
+                VariableIndicesInfo variableInfo
+                {
+                    token.range + offset,
+                    tokens[equalsToken].range.begin + offset,
+                    tokens[nameToken].range + offset,
+                    value,
+                    (semicolonToken < tokensCount ? tokens[semicolonToken].range.begin : static_cast<index>(scope.size())) + offset,
+                    tokens[valueToken].type == TokenType::ScopeOpen
+                };
+
+                std::string variablePath = path;
+                variablePath += tokens[nameToken].range.GetSubstring<std::string_view>(scope);
+
+                if(!EmplaceFirst(m_Variables, std::move(variablePath), variableInfo))
+                    m_HasRepeatedPaths = true;
+
+                t = semicolonToken;
+            }
+        }
+    }
+
+    void ConfigFile::Parser::SourceIndex::Shift(index position, index offset)
+    {
+        const auto shift = [position, offset](index& i)
+            {
+                if(i >= position)
+                    i += offset;
+            };
+        const auto shiftRange = [&shift](StringRange& range)
+            {
+                shift(range.begin);
+                shift(range.end);
+            };
+
+        for(auto& [path, namespaceInfo] : m_Namespaces)
+        {
+            shiftRange(namespaceInfo.keyword);
+            shiftRange(namespaceInfo.name);
+            shiftRange(namespaceInfo.scope);
+        }
+        //the indices of an empty value are std::string::npos, which is never shifted as it is negative
+        for(auto& [path, variableInfo] : m_Variables)
+        {
+            shiftRange(variableInfo.type);
+            shift(variableInfo.equals);
+            shiftRange(variableInfo.name);
+            shiftRange(variableInfo.value);
+            shift(variableInfo.semicolon);
+        }
+    }
+
+    void ConfigFile::Parser::SourceIndex::OnInserted(const std::string_view& scope, index position, index count)
+    {
+        if(m_HasRepeatedPaths)
+        {
+            *this = SourceIndex{ scope };
+            return;
+        }
+
+        //the innermost namespace which contains position
+        const std::string* parentPath = nullptr;
+        index parentScopeBegin = -1;
+
+        for(const auto& [path, namespaceInfo] : m_Namespaces)
+            if(namespaceInfo.scope.begin < position && position <= namespaceInfo.scope.end && namespaceInfo.scope.begin > parentScopeBegin)
+            {
+                parentPath = &path;
+                parentScopeBegin = namespaceInfo.scope.begin;
+            }
+
+        std::string path;
+        if(parentPath)
+        {
+            path = *parentPath;
+            path += PATH_SEPARATOR;
+        }
+
+        Shift(position, count);
+
+        Add(scope.substr(position, count), position, std::move(path));
+    }
+    void ConfigFile::Parser::SourceIndex::OnErased(const std::string_view& scope, index begin, index end)
+    {
+        if(m_HasRepeatedPaths)
+        {
+            *this = SourceIndex{ scope };
+            return;
+        }
+
+        const auto isErased = [begin, end](const auto& item) { return ReceiveBeginIndex(item.second) >= begin && ReceiveEndIndex(item.second) <= end; };
+
+        std::erase_if(m_Namespaces, isErased);
+        std::erase_if(m_Variables, isErased);
+
+        Shift(end + 1, begin - end - 1);
+    }
+
+    //idk it is better to make code of those two func clearer but how?
+    ConfigFile::Parser::NamespaceIndicesInfo ConfigFile::Parser::ReceiveNamespaceInfo(const std::string_view& scope, const index& namespaceKeywordBeginIndex)
+    {
+        const index namespaceKeywordEndIndex = namespaceKeywordBeginIndex + NAMESPACE_KEYWORD.size() - 1;
+
+        index namespaceNameBeginIndex = namespaceKeywordEndIndex + 1;
+
+        //
+        for(bool isCommented = false; namespaceNameBeginIndex < scope.size(); namespaceNameBeginIndex++)
+        {
+            char currentChar = scope[namespaceNameBeginIndex];
+
+            if(isCommented && currentChar == NEWLINE)
+                isCommented = false;
+            else if(!isCommented)
+            {
+                if(IsFullSubstringSame(scope, namespaceNameBeginIndex, COMMENT_SCOPE_LINE))
+                    isCommented = true;
+                else if(Variable::IsValidVariableChar(currentChar))
+                    break;
+            }
+        }
+
+        index namespaceNameEndIndex = namespaceNameBeginIndex + 1;//
+
+        index namespaceScopeBeginIndex = namespaceNameEndIndex + 1;
+
+        //
+        for(bool isCommented = false; namespaceScopeBeginIndex < scope.size(); namespaceScopeBeginIndex++)
+        {
+            char currentChar = scope[namespaceScopeBeginIndex];
+
+            if(isCommented && currentChar == NEWLINE)
+                isCommented = false;
+            else if(!isCommented)
+            {
+                if(IsFullSubstringSame(scope, namespaceScopeBeginIndex, COMMENT_SCOPE_LINE))
+                    isCommented = true;
+                else if(Variable::IsValidVariableChar(currentChar))
+                    namespaceNameEndIndex = namespaceScopeBeginIndex;
+                else if(currentChar == SCOPE_OPEN)
+                    break;
+            }
+        }
+
+        //wft? it could be done via DetermineParsingDataType
+        //TODO: maybe make here a loop and use DetermineParsingDataType
+        index namespaceScopeEndIndex = namespaceScopeBeginIndex + 1;
+
+        bool isValueScopeClosed = true;
+        bool isCommentScopeClosed = true;
+
+        for(size_t openScopeCount = 1, closeScopeCount = 0; namespaceScopeEndIndex < scope.size() && openScopeCount != closeScopeCount; namespaceScopeEndIndex++)
+        {
+            const char currentChar = scope[namespaceScopeEndIndex];
+
+            if(isValueScopeClosed)
+            {
+                if(isCommentScopeClosed && IsFullSubstringSame(scope, namespaceScopeEndIndex, COMMENT_SCOPE_LINE))
+                    isCommentScopeClosed = false;
+                else if(currentChar == NEWLINE)
+                    isCommentScopeClosed = true;
+            }
+            if(isCommentScopeClosed)
+            {
+                if(currentChar == VARIABLE_VALUE_SCOPE)
+                {
+                    //if(!isValueScopeClosed && namespaceScopeEndIndex > 0 && scope[namespaceScopeEndIndex - 1] != SPECIAL_CHAR_SIGN)
+
+                    //if(!isValueScopeClosed && specialCharSignCount % 2 == 0)
+
+                        //isValueScopeClosed = true;
+                    //else
+                        //isValueScopeClosed = false;
+
+                    if(!isValueScopeClosed)
+                    {
+                        size_t specialCharSignCount = 0;
+                        for(index i = namespaceScopeEndIndex - 1; i > 0; i--)
+                        {
+                            char _currentChar = scope[i];
+                            if(_currentChar == SPECIAL_CHAR_SIGN)
+                                specialCharSignCount++;
+                            else
+                                break;
+                        }
+
+                        if(specialCharSignCount % 2 == 0)
+                            isValueScopeClosed = true;
+                    }
+                    else
+                        isValueScopeClosed = false;
+                }
+                else if(isValueScopeClosed)
+                {
+                    if(currentChar == SCOPE_OPEN)
+                        openScopeCount++;
+                    else if(currentChar == SCOPE_CLOSE)
+                        closeScopeCount++;
+                }
+            }
+        }
+
+        //auto dbg1 = std::string_view{scope.begin() + namespaceScopeBeginIndex, scope.begin() + namespaceScopeEndIndex};
+
+        namespaceScopeEndIndex--;
+
+        return
+        {
+            {namespaceKeywordBeginIndex, namespaceKeywordEndIndex},
+            {namespaceNameBeginIndex, namespaceNameEndIndex},
+            {namespaceScopeBeginIndex, namespaceScopeEndIndex}
+        };
+    }
+    ConfigFile::Parser::VariableIndicesInfo ConfigFile::Parser::ReceiveVariableInfo(const std::string_view& scope, const index& variableTypeBeginIndex)
+    {
+        index variableTypeEndIndex = variableTypeBeginIndex + 1;
+
+        char currentChar;
+
+        for(; variableTypeEndIndex < scope.size(); variableTypeEndIndex++)
+        {
+            currentChar = scope[variableTypeEndIndex];
+
+            if(!Variable::IsValidVariableChar(currentChar))
+                break;
+        }
+
+        variableTypeEndIndex--;
+
+        index variableNameBeginIndex = variableTypeEndIndex + 1;
+
+        for(bool isCommented = false; variableNameBeginIndex < scope.size(); variableNameBeginIndex++)
+        {
+            currentChar = scope[variableNameBeginIndex];
+
+            if(isCommented && currentChar == NEWLINE)
+                isCommented = false;
+            else if(!isCommented)
+            {
+                if(IsFullSubstringSame(scope, variableNameBeginIndex, COMMENT_SCOPE_LINE))
+                {
+                    isCommented = true;
+                    variableNameBeginIndex += COMMENT_SCOPE_LINE.size() - 1;
+                }
+                else if(Variable::IsValidVariableChar(currentChar))
+                    break;
+            }
+        }
+
+        index variableNameEndIndex = variableNameBeginIndex + 1;
+        for(; variableNameEndIndex < scope.size(); variableNameEndIndex++)
+        {
+            currentChar = scope[variableNameEndIndex];
+
+            if(!Variable::IsValidVariableChar(currentChar))
+            {
+                if(variableNameEndIndex > 0)
+                    variableNameEndIndex--;
+
+                break;
+            }
+        }
+
+        index equalsIndex = variableNameEndIndex + 1;
+        for(bool isCommented = false; equalsIndex < scope.size(); equalsIndex++)
+        {
+            currentChar = scope[equalsIndex];
+
+            if(isCommented && currentChar == NEWLINE)
+                isCommented = false;
+            else if(!isCommented)
+            {
+                if(IsFullSubstringSame(scope, equalsIndex, COMMENT_SCOPE_LINE))
+                {
+                    isCommented = true;
+                    equalsIndex += COMMENT_SCOPE_LINE.size() - 1;
+                }
+                else if(currentChar == EQUALS)
+                    break;
+            }
+        }
+
+        bool isArray = false;
+
+        index variableValueBeginIndex = equalsIndex + 1;
+        for(bool isCommented = false; variableValueBeginIndex < scope.size(); variableValueBeginIndex++)
+        {
+            currentChar = scope[variableValueBeginIndex];
+
+            if(isCommented && currentChar == NEWLINE)
+                isCommented = false;
+            else if(!isCommented)
+            {
+                if(IsFullSubstringSame(scope, variableValueBeginIndex, COMMENT_SCOPE_LINE))
+                {
+                    isCommented = true;
+                    variableValueBeginIndex += COMMENT_SCOPE_LINE.size() - 1;
+                }
+                else if(currentChar == VARIABLE_VALUE_SCOPE)
+                    break;
+                else if(currentChar == SCOPE_OPEN)
+                {
+                    isArray = true;
+                    break;
+                }
+            }
+        }
+
+        index variableValueEndIndex = variableValueBeginIndex + 1;
+        if(isArray)
+            for(bool isCommented = false, isString = false; variableValueEndIndex < scope.size(); variableValueEndIndex++)
+            {
+                currentChar = scope[variableValueEndIndex];
+
+                if(isCommented && currentChar == NEWLINE)
+                    isCommented = false;
+                else if(!isCommented)
+                {
+                    if(IsFullSubstringSame(scope, variableValueEndIndex, COMMENT_SCOPE_LINE))
+                    {
+                        isCommented = true;
+                        variableValueEndIndex += COMMENT_SCOPE_LINE.size() - 1;
+                    }
+                    //else if(currentChar == VARIABLE_VALUE_SCOPE && (variableValueEndIndex > 0 && scope[variableValueEndIndex - 1] != SPECIAL_CHAR_SIGN || variableValueEndIndex > 1 && scope[variableValueEndIndex - 1] == SPECIAL_CHAR_SIGN && scope[variableValueEndIndex - 2] == SPECIAL_CHAR_SIGN))
+                    else if(currentChar == VARIABLE_VALUE_SCOPE)
+                    {
+                        //TODO: question about specialCharSignCount, maybe variableValueEndIndex - 2? nope it does i--
+                        size_t specialCharSignCount = 0;
+                        for(index i = variableValueEndIndex - 1; i > 0; i--)
+                        {
+                            char _currentChar = scope[i];
+                            if(_currentChar == SPECIAL_CHAR_SIGN)
+                                specialCharSignCount++;
+                            else
+                                break;
+                        }
+
+                        if(specialCharSignCount % 2 == 0)
+                            isString = !isString;
+                    }
+                    else if(!isString && currentChar == SCOPE_CLOSE)
+                        break;
+                }
+            }
+        else
+            for(; variableValueEndIndex < scope.size(); variableValueEndIndex++)
+            {
+                currentChar = scope[variableValueEndIndex];
+                //auto ___ = scope.cbegin() + variableValueEndIndex;
+
+                //if(currentChar == VARIABLE_VALUE_SCOPE && (variableValueEndIndex > 0 && scope[variableValueEndIndex - 1] != SPECIAL_CHAR_SIGN || variableValueEndIndex > 1 && scope[variableValueEndIndex - 1] == SPECIAL_CHAR_SIGN && scope[variableValueEndIndex - 2] == SPECIAL_CHAR_SIGN))
+                if(currentChar == VARIABLE_VALUE_SCOPE)
+                {
+                    size_t specialCharSignCount = 0;
+                    for(index i = variableValueEndIndex - 1; i > 0; i--)
+                    {
+                        char _currentChar = scope[i];
+                        if(_currentChar == SPECIAL_CHAR_SIGN)
+                            specialCharSignCount++;
+                        else
+                            break;
+                    }
+
+                    if(specialCharSignCount % 2 == 0)
+                        break;
+                }
+            }
+
+        index variableValueSemicolon = variableValueEndIndex + 1;
+        for(bool isCommented = false; variableValueSemicolon < scope.size(); variableValueSemicolon++)
+        {
+            currentChar = scope[variableValueSemicolon];
+
+            if(isCommented && currentChar == NEWLINE)
+                isCommented = false;
+            else if(!isCommented)
+            {
+                if(IsFullSubstringSame(scope, variableValueSemicolon, COMMENT_SCOPE_LINE))
+                {
+                    isCommented = true;
+                    variableValueSemicolon += COMMENT_SCOPE_LINE.size() - 1;
+                }
+                else if(currentChar == SEMICOLON)
+                    break;
+            }
+        }
+
+        if(variableValueBeginIndex == variableValueEndIndex - 1)
+        {
+            variableValueBeginIndex = std::string::npos;
+            variableValueEndIndex = std::string::npos;
+        }
+        else
+        {
+            if(!isArray)
+            {
+                variableValueBeginIndex++;
+                variableValueEndIndex--;
+            }
+        }
+
+        return
+        {
+            {variableTypeBeginIndex, variableTypeEndIndex},
+            equalsIndex,
+            {variableNameBeginIndex, variableNameEndIndex},
+            {variableValueBeginIndex, variableValueEndIndex},
+            variableValueSemicolon,
+            isArray
+        };
+    }
+
+    ConfigFile::Parser::NamespaceIndicesInfo ConfigFile::Parser::FindNamespace(const std::string_view& scope, const std::string_view& path)
+    {
+        if(path.empty())
+            throw std::invalid_argument{ "namespace path is empty" };
+
+        bool isCommentScopeClosed = true;
+        bool isValueScopeClosed = true;
+
+        for(index i = 0; i < scope.size(); i++)
+        {
+            const ParsingDataType parsingDataType = DetermineParsingDataType(scope, i, isCommentScopeClosed, isValueScopeClosed);
+
+            if(parsingDataType == ParsingDataType::Namespace)
+            {
+                const NamespaceIndicesInfo namespaceIndicesInfo = ReceiveNamespaceInfo(scope, i);
+
+                //const std::string_view foundNamespaceName{ scope.cbegin() + namespaceIndicesInfo.nameBegin, scope.cbegin() + namespaceIndicesInfo.nameEnd + 1 };
+                const std::string_view foundNamespaceName = namespaceIndicesInfo.name.GetSubstring<std::string_view>(scope);
+
+                const index pathSeparatorIndex = path.find('/');
+
+                //current namespace path name so namespace1/namespace2/namespace3
+                //                               ^ starts from the beginning, cuz you need to think
+                const std::string_view currentPath{ path.cbegin(), path.cbegin() + (pathSeparatorIndex == std::string::npos ? path.size() : pathSeparatorIndex) };
+
+                if(currentPath == foundNamespaceName)
+                {
+                    if(pathSeparatorIndex == std::string::npos)
+                        return namespaceIndicesInfo;
+                    else
+                    {
+                        //but there could be multiple namespaces with the same name
+                        const std::string_view nextPath{ path.cbegin() + currentPath.size() + 1, path.cend() };
+
+                        //const std::string_view nextScope{ scope.cbegin() + namespaceIndicesInfo.scopeBegin, scope.cbegin() + namespaceIndicesInfo.scopeEnd };
+                        const std::string_view nextScope = namespaceIndicesInfo.scope.GetSubstring<std::string_view>(scope);
+
+                        //wtf is wrong with returning indices?
+                        auto n = FindNamespace(nextScope, nextPath);
+
+                        return n + namespaceIndicesInfo.scope.begin;
+                    }
+                }
+
+                i = namespaceIndicesInfo.scope.end;
+            }
+        }
+
+        throw std::out_of_range{ "Failed to find namespace" };
+    }
+
+    ConfigFile::Parser::VariableIndicesInfo ConfigFile::Parser::FindVariableInfo(const std::string_view& scope, const std::string_view& path)
+    {
+        const index lastPathSeparatorIndex = path.find_last_of('/');
+
+        const std::string_view namespacePath = (lastPathSeparatorIndex == std::string::npos ? "" : std::string_view{ path.cbegin(), path.cbegin() + lastPathSeparatorIndex });
+        const std::string_view toFindVariableName{ path.cbegin() + (lastPathSeparatorIndex == std::string::npos ? 0 : lastPathSeparatorIndex + 1), path.cend() };
+
+        if(lastPathSeparatorIndex == std::string::npos)
+        {
+            bool isCommentScopeClosed = true;
+            bool isValueScopeClosed = true;
+
+            for(index j = 0; j < scope.size(); j++)
+            {
+                const ParsingDataType parsingDataType = DetermineParsingDataType(scope, j, isCommentScopeClosed, isValueScopeClosed);
+
+                if(parsingDataType == ParsingDataType::Variable)
+                {
+                    const VariableIndicesInfo variableInfo = ReceiveVariableInfo(scope, j);
+
+                    const std::string_view variableName = variableInfo.name.GetSubstring<std::string_view>(scope);
+
+                    if(variableName == toFindVariableName)
+                        return variableInfo;
+
+                    j = variableInfo.semicolon + 1;
+                }
+                else if(parsingDataType == ParsingDataType::Namespace)
+                {
+                    const NamespaceIndicesInfo namespaceInfo = ReceiveNamespaceInfo(scope, j);
+
+                    j = namespaceInfo.scope.end;
+                }
+            }
+        }
+        else
+        {
+            std::string_view nextScope{ scope };
+            index offset = 0;
+
+            for(NamespaceIndicesInfo namespaceInfo = FindNamespace(nextScope, namespacePath); namespaceInfo.scope.end < scope.size(); namespaceInfo = FindNamespace(nextScope, namespacePath))
+            {
+                const std::string_view namespaceScope = namespaceInfo.scope.GetSubstring<std::string_view>(nextScope);
+
+                bool isCommentScopeClosed = true;
+                bool isValueScopeClosed = true;
+
+                for(index j = 0; j < namespaceScope.size(); j++)
+                {
+                    const ParsingDataType parsingDataType = DetermineParsingDataType(namespaceScope, j, isCommentScopeClosed, isValueScopeClosed);
+
+                    if(parsingDataType == ParsingDataType::Variable)
+                    {
+                        const VariableIndicesInfo variableInfo = ReceiveVariableInfo(namespaceScope, j);
+
+                        const std::string_view variableName = variableInfo.name.GetSubstring<std::string_view>(namespaceScope);
+
+                        if(variableName == toFindVariableName)
+                            return variableInfo + offset + namespaceInfo.scope.begin;
+
+                        j = variableInfo.semicolon + 1;
+                    }
+                }
+
+                nextScope = std::string_view{ nextScope.cbegin() + namespaceInfo.scope.end + 1, nextScope.cend() };
+                offset += namespaceInfo.scope.end + 1;
+            }
+        }
+
+        throw std::out_of_range{ "failed to find variable" };
+    }
+    Variable ConfigFile::Parser::FindVariable(const std::string_view& scope, const std::string_view& path)
+    {
+        const VariableIndicesInfo info = FindVariableInfo(scope, path);
+
+        const std::string_view variableValueRaw = info.value.GetSubstring<std::string_view>(scope);
+        std::string variableValue = RemoveSpecialChars(variableValueRaw);
+
+        return Variable{ std::string{ path }, std::move(variableValue), StringToDataType(info.type.GetSubstring<std::string_view>(scope)), IsArray(variableValueRaw) };
+    }
+
+    void AddChar(std::stringstream& ss, char ch, size_t amount = 1)
+    {
+        for(size_t i = 0; i < amount; i++)
+            ss << ch;
+    }
+
+    std::string ConfigFile::Parser::WriteVariable(std::string scope, const Variable& variable, StringRange scopeRange)
+    {
+        index insertIndex;
+
+        return WriteVariable(std::move(scope), variable, scopeRange, insertIndex);
+    }
+    std::string ConfigFile::Parser::WriteVariable(std::string scope, const Variable& variable, StringRange scopeRange, index& insertIndex)
+    {
+        bool doesScopeExist = true;
+
+        const std::string_view path = variable.GetPath();
+
+        index prevPathSeparatorOffset;
+        index pathSeparatorOffset = path.find(PATH_SEPARATOR);
+
+        std::string_view currentNamespace;
+
+        std::string_view currentScope;
+        index insertOffset;
+
+        scopeRange = CorrectStringRange(scope, scopeRange);
+        insertOffset = scopeRange.begin;
+
+        currentScope = scopeRange.GetSubstring<std::string_view>(scope);
+
+        /*if(scopeRange.IsValid())
+        {
+            insertOffset = scopeRange.begin;
+            currentScope = scopeRange.GetSubstring<std::string_view>(scope);
+        }
+        else
+        {
+            insertOffset = 0;
+            currentScope = scope;
+        }*/
+
+        //finding the scope wee need
+        //if(scopeRange.IsValid() && scopeRange.begin == scopeRange.end)
+        if(scopeRange.begin == scopeRange.end)
+        {
+            const index pathSeparatorIndex = path.find(PATH_SEPARATOR);
+
+            if(pathSeparatorIndex != std::string::npos)
+            {
+                doesScopeExist = false;
+
+                currentNamespace = { path.cbegin(), path.cbegin() + pathSeparatorIndex };
+            }
+
+        }
+        else
+        {
+            index localNamespaceSize = 0;
+            //for debug only
+            NamespaceIndicesInfo namespaceIndicesInfo;
+            try
+            {
+                //std::vector<std::string_view> dbgs;
+                for(prevPathSeparatorOffset = 0; pathSeparatorOffset != std::string::npos; prevPathSeparatorOffset = pathSeparatorOffset + 1, pathSeparatorOffset = path.find(PATH_SEPARATOR, prevPathSeparatorOffset))
+                {
+                    currentNamespace = { path.cbegin() + prevPathSeparatorOffset, path.cbegin() + pathSeparatorOffset };
+
+                    //NamespaceIndicesInfo namespaceIndicesInfo = FindNamespace(currentScope, currentNamespace);
+                    namespaceIndicesInfo = FindNamespace(currentScope, currentNamespace);
+
+                    localNamespaceSize = namespaceIndicesInfo.scope.end - namespaceIndicesInfo.scope.begin;
+
+                    currentScope = namespaceIndicesInfo.scope.GetSubstring<std::string_view>(currentScope);
+                    insertOffset += namespaceIndicesInfo.scope.begin;
+
+                    //dbgs.push_back(currentScope);
+                }
+            }
+            catch(...)
+            {
+                doesScopeExist = false;
+            }
+
+            if(localNamespaceSize > 0)
+                //TODO: this is wrong
+                insertOffset += localNamespaceSize - 1;
+
+            //check for comments offset
+            //error here i is too big
+            if(!insertOffset)
+            {
+                bool isCommented = false;
+                for(index& i = insertOffset; i < currentScope.size(); i++)
+                {
+                    const char currentChar = currentScope[i];
+
+                    if(isCommented && currentChar == NEWLINE)
+                    {
+                        //insertOffset = i;
+
+                        isCommented = false;
+                        break;
+                    }
+                    else if(!isCommented)
+                    {
+                        if(IsFullSubstringSame(currentScope, i, COMMENT_SCOPE_LINE))
+                        {
+                            isCommented = true;
+                            i += COMMENT_SCOPE_LINE.size() - 1;
+
+                            //insertOffset = i;
+                        }
+                    }
+                }
+            }
+        }
+
+        if(doesScopeExist)
+        {
+            std::stringstream variableToInsertStringStream;
+
+            variableToInsertStringStream << DataTypeToString(variable.GetType()) << ' ' << variable.GetName() << ' ' << EQUALS << ' ';
+            if(variable.IsArray())
+                variableToInsertStringStream << SCOPE_OPEN << variable.GetRawValue() << SCOPE_CLOSE;
+            else
+                variableToInsertStringStream << VARIABLE_VALUE_SCOPE << variable.GetRawValue() << VARIABLE_VALUE_SCOPE;
+
+            variableToInsertStringStream << SEMICOLON;
+
+            const bool add = insertOffset == scope.size() || !insertOffset ? false : !scope.empty();
+            insertIndex = insertOffset + add;
+            //ahhh... copying
+            scope.insert(insertIndex, variableToInsertStringStream.str());
+        }
+        else
+        {
+            //the scope doesn't exist, so we need to create it
+            std::stringstream newScope;
+
+            size_t scopesOpenedCount = 0;
+
+            for(prevPathSeparatorOffset = pathSeparatorOffset + 1, pathSeparatorOffset = path.find(PATH_SEPARATOR, prevPathSeparatorOffset); true; prevPathSeparatorOffset = pathSeparatorOffset + 1, pathSeparatorOffset = path.find(PATH_SEPARATOR, prevPathSeparatorOffset))
+            {
+                scopesOpenedCount++;
+
+                newScope << NAMESPACE_KEYWORD << ' ' << currentNamespace << SCOPE_OPEN;
+
+                if(pathSeparatorOffset == std::string::npos)
+                    break;
+
+                currentNamespace = { path.cbegin() + prevPathSeparatorOffset, path.cbegin() + pathSeparatorOffset };
+            }
+
+            newScope << DataTypeToString(variable.GetType()) << ' ' << variable.GetName() << ' ' << EQUALS << ' ';
+            if(variable.IsArray())
+                newScope << SCOPE_OPEN << variable.GetRawValue() << SCOPE_CLOSE;
+            else
+                newScope << VARIABLE_VALUE_SCOPE << variable.GetRawValue() << VARIABLE_VALUE_SCOPE;
+
+            newScope << SEMICOLON;
+
+            AddChar(newScope, SCOPE_CLOSE, scopesOpenedCount);
+
+            const bool add = insertOffset == scope.size() ? false : !scope.empty();
+            insertIndex = insertOffset + add;
+            //ahhh... copying
+            scope.insert(insertIndex, newScope.str());
+        }
+
+        return scope;
+    }
+
+    std::string ConfigFile::Parser::WriteVariables(std::string scope, const std::vector<Variable>& variables, StringRange scopeRange)
+    {
+        //the whole scope, so there is no need to reparse it for every variable
+        if(!scopeRange.IsValid())
+            return ApplyChanges(scope, variables);
+
+        size_t toReserve = 0;
+
+        //also it is possible to do the same stuff for namespaces, but ...
+        for(auto&& variable : variables)
+            toReserve += DetermineReserveSize(variable);
+
+        scope.reserve(scope.size() + toReserve);
+
+        for(auto&& variable : variables)
+        {
+            //bool dbgBool = IsFullSubstringSame(variable.GetName(), 0, "attachment0Path");
+
+            scope = WriteVariable(std::move(scope), variable, scopeRange);
+        }
+
+        return scope;
+    }
+
+    //TODO:
+    std::string ConfigFile::Parser::WriteVariableAfter(std::string scope, const Variable& variable, const std::string_view& after, StringRange scopeRange)
+    {
+        scopeRange = CorrectStringRange(scope, scopeRange);
+        //std::string_view scopeView = scopeRange.IsValid() ? scopeRange.GetSubstring<std::string_view>(scope) : scope;
+        std::string_view scopeView = scopeRange.GetSubstring<std::string_view>(scope);
+        try
+        {
+            VariableIndicesInfo variableIndicesInfo = FindVariableInfo(scopeView, after);
+
+            return WriteVariable(std::move(scope), variable, StringRange{ variableIndicesInfo.semicolon, variableIndicesInfo.semicolon });
+            //return WriteVariable(std::move(scope), variable, (scopeRange.IsValid() ? StringRange{variableIndicesInfo.semicolon + 1, scopeRange.end} : StringRange{variableIndicesInfo.semicolon + 1, static_cast<index>(scope.size() - 1)}));
+        }
+        catch(...)
+        {
+            NamespaceIndicesInfo namespaceIndicesInfo = FindNamespace(scopeView, after);
+
+            return WriteVariable(std::move(scope), variable, StringRange{ namespaceIndicesInfo.scope.end, namespaceIndicesInfo.scope.end });
+            //return WriteVariable(std::move(scope), variable, (scopeRange.IsValid() ? StringRange{namespaceIndicesInfo.scope.end + 1, scopeRange.end} : StringRange{namespaceIndicesInfo.scope.end + 1, static_cast<index>(scope.size() - 1)}));
+        }
+    }
+    std::string ConfigFile::Parser::WriteVariablesAfter(std::string scope, const std::vector<Variable>& variables, const std::string_view& after, StringRange scopeRange)
+    {
+        scopeRange = CorrectStringRange(scope, scopeRange);
+        //std::string_view scopeView = scopeRange.IsValid() ? scopeRange.GetSubstring<std::string_view>(scope) : scope;
+        std::string_view scopeView = scopeRange.GetSubstring<std::string_view>(scope);
+        try
+        {
+            VariableIndicesInfo variableIndicesInfo = FindVariableInfo(scopeView, after);
+
+            return WriteVariables(std::move(scope), variables, { variableIndicesInfo.semicolon, variableIndicesInfo.semicolon });
+            //return WriteVariables(std::move(scope), variables, (scopeRange.IsValid() ? StringRange{variableIndicesInfo.semicolon + 1, scopeRange.end} : StringRange{variableIndicesInfo.semicolon + 1, static_cast<index>(scope.size() - 1)}));
+        }
+        catch(...)
+        {
+            NamespaceIndicesInfo namespaceIndicesInfo = FindNamespace(scopeView, after);
+
+            return WriteVariables(std::move(scope), variables, { namespaceIndicesInfo.scope.end, namespaceIndicesInfo.scope.end });
+            //return WriteVariables(std::move(scope), variables, (scopeRange.IsValid() ? StringRange{namespaceIndicesInfo.scope.end + 1, scopeRange.end} : StringRange{namespaceIndicesInfo.scope.end + 1, static_cast<index>(scope.size() - 1)}));
+        }
+    }
+    std::string ConfigFile::Parser::WriteVariableBefore(std::string scope, const Variable& variable, const std::string_view& before, StringRange scopeRange)
+    {
+        scopeRange = CorrectStringRange(scope, scopeRange);
+        //std::string_view scopeView = scopeRange.IsValid() ? scopeRange.GetSubstring<std::string_view>(scope) : scope;
+        std::string_view scopeView = scopeRange.GetSubstring<std::string_view>(scope);
+        try
+        {
+            VariableIndicesInfo variableIndicesInfo = FindVariableInfo(scopeView, before);
+
+            StringRange stringRange = { variableIndicesInfo.type.begin, variableIndicesInfo.type.begin };
+            //WriteVariable inserts right after the char at the range begin (if it is not the first one)
+            if(stringRange.begin > 0)
+                stringRange += -1;
+
+            return WriteVariable(std::move(scope), variable, stringRange);
+        }
+        catch(...)
+        {
+            NamespaceIndicesInfo namespaceIndicesInfo = FindNamespace(scopeView, before);
+
+            StringRange stringRange = { namespaceIndicesInfo.keyword.begin, namespaceIndicesInfo.keyword.begin };
+            //WriteVariable inserts right after the char at the range begin (if it is not the first one)
+            if(stringRange.begin > 0)
+                stringRange += -1;
+
+            return WriteVariable(std::move(scope), variable, stringRange);
+        }
+    }
+    std::string ConfigFile::Parser::WriteVariablesBefore(std::string scope, const std::vector<Variable>& variables, const std::string_view& before, StringRange scopeRange)
+    {
+        scopeRange = CorrectStringRange(scope, scopeRange);
+        //std::string_view scopeView = scopeRange.IsValid() ? scopeRange.GetSubstring<std::string_view>(scope) : scope;
+        std::string_view scopeView = scopeRange.GetSubstring<std::string_view>(scope);
+        try
+        {
+            VariableIndicesInfo variableIndicesInfo = FindVariableInfo(scopeView, before);
+
+            return WriteVariables(std::move(scope), variables, (scopeRange.IsValid() ? StringRange{ scopeRange.begin, variableIndicesInfo.semicolon + 1 } : StringRange{ 0, variableIndicesInfo.semicolon + 1 }));
+        }
+        catch(...)
+        {
+            NamespaceIndicesInfo namespaceIndicesInfo = FindNamespace(scopeView, before);
+
+            return WriteVariables(std::move(scope), variables, (scopeRange.IsValid() ? StringRange{ scopeRange.begin, namespaceIndicesInfo.scope.end + 1 } : StringRange{ 0, namespaceIndicesInfo.scope.end + 1 }));
+        }
+    }
+
+    std::string ConfigFile::Parser::DeleteNamespace(std::string scope, const std::string_view& path)
+    {
+        NamespaceIndicesInfo namespaceIndicesInfo = FindNamespace(scope, path);
+
+        scope.erase(scope.cbegin() + namespaceIndicesInfo.keyword.begin, scope.cbegin() + namespaceIndicesInfo.scope.end + 1);
+
+        return scope;
+    }
+    std::string ConfigFile::Parser::DeleteVariable(std::string scope, const std::string_view& path)
+    {
+        VariableIndicesInfo variableIndicesInfo = FindVariableInfo(scope, path);
+
+        scope.erase(scope.cbegin() + variableIndicesInfo.type.begin, scope.cbegin() + variableIndicesInfo.semicolon + 1);
+
+        return scope;
+    }
+
+    std::string ConfigFile::Parser::WriteVariableAfter(std::string scope, const Variable& variable, const std::string_view& after, SourceIndex& sourceIndex)
+    {
+        const size_t sizeBefore = scope.size();
+        index insertIndex;
+
+        if(sourceIndex.DoesVariableExist(after))
+        {
+            const index semicolon = sourceIndex.FindVariableInfo(after).semicolon;
+
+            scope = WriteVariable(std::move(scope), variable, StringRange{ semicolon, semicolon }, insertIndex);
+        }
+        else
+        {
+            const index scopeEnd = sourceIndex.FindNamespace(after).scope.end;
+
+            scope = WriteVariable(std::move(scope), variable, StringRange{ scopeEnd, scopeEnd }, insertIndex);
+        }
+
+        sourceIndex.OnInserted(scope, insertIndex, scope.size() - sizeBefore);
+
+        return scope;
+    }
+    std::string ConfigFile::Parser::WriteVariableBefore(std::string scope, const Variable& variable, const std::string_view& before, SourceIndex& sourceIndex)
+    {
+        const index beforeBegin = sourceIndex.DoesVariableExist(before) ? sourceIndex.FindVariableInfo(before).type.begin : sourceIndex.FindNamespace(before).keyword.begin;
+
+        //WriteVariable inserts right after the char at the range begin (if it is not the first one)
+        StringRange stringRange = { beforeBegin, beforeBegin };
+        if(stringRange.begin > 0)
+            stringRange += -1;
+
+        const size_t sizeBefore = scope.size();
+        index insertIndex;
+
+        scope = WriteVariable(std::move(scope), variable, stringRange, insertIndex);
+
+        sourceIndex.OnInserted(scope, insertIndex, scope.size() - sizeBefore);
+
+        return scope;
+    }
+
+    std::string ConfigFile::Parser::DeleteNamespace(std::string scope, const std::string_view& path, SourceIndex& sourceIndex)
+    {
+        const NamespaceIndicesInfo namespaceIndicesInfo = sourceIndex.FindNamespace(path);
+
+        scope.erase(scope.cbegin() + namespaceIndicesInfo.keyword.begin, scope.cbegin() + namespaceIndicesInfo.scope.end + 1);
+
+        sourceIndex.OnErased(scope, namespaceIndicesInfo.keyword.begin, namespaceIndicesInfo.scope.end);
+
+        return scope;
+    }
+    std::string ConfigFile::Parser::DeleteVariable(std::string scope, const std::string_view& path, SourceIndex& sourceIndex)
+    {
+        const VariableIndicesInfo variableIndicesInfo = sourceIndex.FindVariableInfo(path);
+
+        scope.erase(scope.cbegin() + variableIndicesInfo.type.begin, scope.cbegin() + variableIndicesInfo.semicolon + 1);
+
+        sourceIndex.OnErased(scope, variableIndicesInfo.type.begin, variableIndicesInfo.semicolon);
+
+        return scope;
+    }
+
+    namespace
+    {
+        //the namespace where ApplyChanges inserts the variables: an existing one, or a new one that is created inside its parent
+        struct PendingNamespace
+        {
+            std::string_view name;
+            std::vector<const Variable*> variables;
+            //indices of the new namespaces inside this one
+            std::vector<size_t> children;
+        };
+
+        void AppendVariableStatement(std::string& output, const Variable& variable)
+        {
+            using Parser = ConfigFile::Parser;
+
+            output += DataTypeToString(variable.GetType());
+            output += ' ';
+            output += variable.GetName();
+            output += ' ';
+            output += Parser::EQUALS;
+            output += ' ';
+
+            //arrays keep their special chars
+            if(variable.IsArray())
+            {
+                output += Parser::SCOPE_OPEN;
+                output += variable.GetRawValue();
+                output += Parser::SCOPE_CLOSE;
+            }
+            else
+            {
+                output += Parser::VARIABLE_VALUE_SCOPE;
+                output += Parser::AddSpecialChars(std::string{ variable.GetRawValue() });
+                output += Parser::VARIABLE_VALUE_SCOPE;
+            }
+
+            output += Parser::SEMICOLON;
+        }
+        //appends the variables and the new namespaces, but not the scope of pendingNamespace itself
+        void AppendPendingNamespace(std::string& output, const std::vector<PendingNamespace>& pendingNamespaces, size_t pendingNamespace)
+        {
+            using Parser = ConfigFile::Parser;
+
+            for(const Variable* variable : pendingNamespaces[pendingNamespace].variables)
+                AppendVariableStatement(output, *variable);
+
+            for(const size_t child : pendingNamespaces[pendingNamespace].children)
+            {
+                output += Parser::NAMESPACE_KEYWORD;
+                output += ' ';
+                output += pendingNamespaces[child].name;
+                output += Parser::SCOPE_OPEN;
+
+                AppendPendingNamespace(output, pendingNamespaces, child);
+
+                output += Parser::SCOPE_CLOSE;
+            }
+        }
+    }
+
+    std::string ConfigFile::Parser::ApplyChanges(const std::string_view& scope, const std::vector<Variable>& variablesToWrite, const std::vector<std::string_view>& pathsToDelete)
+    {
+        const std::vector<Token> tokens = Tokenize(scope);
+
+        std::unordered_map<std::string, StringRange> namespaceScopes;
+        std::unordered_map<std::string, StringRange> variableRanges;
+
+        ReceiveScopeLayout(scope, tokens, namespaceScopes, variableRanges);
+
+        //erases erasedSize chars from begin, or inserts the pending namespace before begin
+        struct Edit
+        {
+            index begin;
+            index erasedSize;
+            size_t pendingNamespace;
+        };
+
+        constexpr size_t NO_PENDING_NAMESPACE = std::numeric_limits<size_t>::max();
+
+        std::vector<Edit> edits;
+        edits.reserve(pathsToDelete.size());
+
+        for(const std::string_view& path : pathsToDelete)
+        {
+            const auto variableRange = variableRanges.find(std::string{ path });
+
+            if(variableRange == variableRanges.cend())
+                throw std::invalid_argument{ "Failed to find variable" };
+
+            edits.push_back({ variableRange->second.begin, variableRange->second.end - variableRange->second.begin + 1, NO_PENDING_NAMESPACE });
+
+            //so the same variable cannot be deleted twice
+            variableRanges.erase(variableRange);
+        }
+
+        std::vector<PendingNamespace> pendingNamespaces;
+        //by the paths of the existing namespaces, the root one is ""
+        std::unordered_map<std::string_view, size_t> insertionPoints;
+
+        size_t toReserve = scope.size() + 1;
+
+        for(const Variable& variable : variablesToWrite)
+        {
+            const std::string_view path = variable.GetPath();
+
+            toReserve += DetermineReserveSize(variable);
+
+            //the longest namespace path that exists in scope
+            size_t existingPathEnd = path.rfind(PATH_SEPARATOR);
+
+            while(existingPathEnd != std::string_view::npos && !namespaceScopes.contains(std::string{ path.substr(0, existingPathEnd) }))
+                existingPathEnd = existingPathEnd ? path.rfind(PATH_SEPARATOR, existingPathEnd - 1) : std::string_view::npos;
+
+            const std::string_view existingPath = existingPathEnd != std::string_view::npos ? path.substr(0, existingPathEnd) : std::string_view{};
+
+            const auto [insertionPoint, isNewInsertionPoint] = insertionPoints.try_emplace(existingPath, pendingNamespaces.size());
+
+            if(isNewInsertionPoint)
+            {
+                pendingNamespaces.push_back({ existingPath, {}, {} });
+
+                //before SCOPE_CLOSE of the namespace or at the end of the root one
+                const index insertOffset = existingPath.empty() ? static_cast<index>(scope.size()) : namespaceScopes.find(std::string{ existingPath })->second.end;
+
+                edits.push_back({ insertOffset, 0, insertionPoint->second });
+            }
+
+            size_t currentNamespace = insertionPoint->second;
+
+            //the namespaces that don't exist yet
+            for(size_t nameBegin = existingPathEnd != std::string_view::npos ? existingPathEnd + 1 : 0, nameEnd = path.find(PATH_SEPARATOR, nameBegin); nameEnd != std::string_view::npos; nameBegin = nameEnd + 1, nameEnd = path.find(PATH_SEPARATOR, nameBegin))
+            {
+                const std::string_view name = path.substr(nameBegin, nameEnd - nameBegin);
+                const std::vector<size_t>& children = pendingNamespaces[currentNamespace].children;
+
+                const auto child = std::find_if(children.cbegin(), children.cend(), [&pendingNamespaces, &name](size_t child) { return pendingNamespaces[child].name == name; });
+
+                if(child != children.cend())
+                    currentNamespace = *child;
+                else
+                {
+                    pendingNamespaces[currentNamespace].children.push_back(pendingNamespaces.size());
+                    pendingNamespaces.push_back({ name, {}, {} });
+
+                    currentNamespace = pendingNamespaces.size() - 1;
+
+                    toReserve += NAMESPACE_KEYWORD.size() + name.size() + 3;//WHITESPACE, SCOPE_OPEN, SCOPE_CLOSE
+                }
+            }
+
+            pendingNamespaces[currentNamespace].variables.push_back(&variable);
+        }
+
+        //deletes and inserts never overlap, because variables cannot contain SCOPE_CLOSE of namespaces
+        std::stable_sort(edits.begin(), edits.end(), [](const Edit& lhs, const Edit& rhs) { return lhs.begin < rhs.begin; });
+
+        std::string result;
+        result.reserve(toReserve);
+
+        index copiedEnd = 0;
+
+        for(const Edit& edit : edits)
+        {
+            result.append(scope.data() + copiedEnd, scope.data() + edit.begin);
+            copiedEnd = edit.begin + edit.erasedSize;
+
+            if(edit.pendingNamespace == NO_PENDING_NAMESPACE)
+                continue;
+
+            //a comment at the very end of the source would comment out the inserted variables
+            if(edit.begin == static_cast<index>(scope.size()) && !tokens.empty() && tokens.back().type == TokenType::Comment && tokens.back().range.end == edit.begin - 1)
+                result += NEWLINE;
+
+            AppendPendingNamespace(result, pendingNamespaces, edit.pendingNamespace);
+        }
+
+        result.append(scope.data() + copiedEnd, scope.data() + scope.size());
+
+        return result;
+    }
+
+    //the formatted output followed by the not yet consumed rest of the source, FormatScope indexes it as one string.
+    //Everything is inserted or erased at the boundary between them, so the output is only appended to and the source is read once
+    struct ConfigFile::Parser::FormattingBuffer
+    {
+        FormattingBuffer(const std::string_view& source)
+            : source(source), sourcePosition(0)
+        {
+            //indentation and newlines are mostly added, not removed
+            output.reserve(source.size() + source.size() / 2);
+        }
+
+        char operator[](index i) const
+        {
+            if(i < Boundary())
+                return output[i];
+
+            const index sourceIndex = sourcePosition + (i - Boundary());
+
+            return sourceIndex < static_cast<index>(source.size()) ? source[sourceIndex] : '\0';
+        }
+
+        size_t Size() const noexcept
+        {
+            return output.size() + (source.size() - sourcePosition);
+        }
+        index Boundary() const noexcept
+        {
+            return static_cast<index>(output.size());
+        }
+        //adding it to the index of a source char gives the index of that char in the buffer
+        index SourceOffset() const noexcept
+        {
+            return Boundary() - sourcePosition;
+        }
+
+        //the chars passed by are copied as they are
+        void MoveTo(index i)
+        {
+            if(i > Boundary())
+            {
+                const index count = std::min(i - Boundary(), static_cast<index>(source.size()) - sourcePosition);
+
+                output.append(source.data() + sourcePosition, count);
+                sourcePosition += count;
+            }
+
+            //a nested FormatScope may return an index behind what it has already formatted, those chars are given back to the source
+            if(i < Boundary())
+            {
+                const index count = Boundary() - i;
+
+                if(sourcePosition >= count && std::string_view{ output }.substr(i) == source.substr(sourcePosition - count, count))
+                    sourcePosition -= count;
+                else
+                {
+                    std::string givenBack = output.substr(i);
+                    givenBack.append(source.substr(sourcePosition));
+
+                    ownedSource = std::move(givenBack);
+                    source = ownedSource;
+                    sourcePosition = 0;
+                }
+
+                output.resize(i);
+            }
+        }
+        void Insert(index i, const std::string_view& string)
+        {
+            MoveTo(i);
+            output.append(string);
+        }
+        void Erase(index i, index count)
+        {
+            if(i == Boundary())
+                sourcePosition = std::min(sourcePosition + count, static_cast<index>(source.size()));
+            else
+            {
+                //the erased chars are right behind the boundary, so only the tail of the output is moved
+                if(i + count > Boundary())
+                    MoveTo(i + count);
+
+                output.erase(i, count);
+            }
+        }
+
+        std::string_view source;
+        index sourcePosition;
+        std::string output;
+        //the source with the chars given back by MoveTo, if they differ from the original ones
+        std::string ownedSource;
+    };
+
+    std::string ConfigFile::Parser::FormatScope(std::string scope, StringRange range)
+    {
+        if(scope.empty())
+            return scope;
+
+        range = CorrectStringRange(scope, range);
+
+        FormattingBuffer buffer{ scope };
+
+        FormatScope(buffer, range, 0);
+
+        buffer.MoveTo(buffer.Size());
+
+        return std::move(buffer.output);
+    }
+
+    ConfigFile::Parser::index ConfigFile::Parser::FormatScope(FormattingBuffer& scope, StringRange& namespaceScope, index scopesOpened, bool wasNewLine)
+    {
+        constexpr size_t ACCEPTABLE_WHITESPACES_COUNT = 1;
+
+        bool isCommentScopeClosed = true;
+        bool isValueScopeClosed = true;
+
+        //returns the amount of inserted chars, nothing is inserted if scopesOpened went below 0 because of an extra SCOPE_CLOSE
+        const auto InsertIndentation = [&scope](index& i, index scopesOpened) -> index
+            {
+                index insertedCharsCount = 0;
+
+                for(index scopeDistancesCount = 0; scopeDistancesCount < scopesOpened; scopeDistancesCount++)
+                {
+                    scope.Insert(i + insertedCharsCount, SCOPE_DISTANCE);
+                    insertedCharsCount += SCOPE_DISTANCE.size();
+                }
+
+                i += insertedCharsCount;
+
+                return insertedCharsCount;
+            };
+
+        bool increment = true;
+        index i;
+        for(i = namespaceScope.begin; i <= namespaceScope.end;)
+        {
+            scope.MoveTo(i);
+
+            if(i >= static_cast<index>(scope.Size()))
+                break;
+
+            const char currentChar = scope[i];
+            const bool isEscaped = i == 0 || scope[i - 1] == SPECIAL_CHAR_SIGN;
+            const ParsingDataType parsingDataType = DetermineParsingDataType(scope.source, scope.sourcePosition, isEscaped, isCommentScopeClosed, isValueScopeClosed);
+
+            if(parsingDataType == ParsingDataType::Invalid)
+            {
+                if(currentChar == SCOPE_OPEN)
+                {
+                    //newline
+                    if(!wasNewLine)
+                    {
+                        scope.Insert(i, { &NEWLINE, 1 });
+
+                        namespaceScope += 1;
+                        i++;
+                    }
+
+                    //tabs
+                    namespaceScope += InsertIndentation(i, scopesOpened);
+
+                    scopesOpened++;
+                }
+                else if(currentChar == SCOPE_CLOSE)
+                {
+                    //newline
+                    if(!wasNewLine && i > 0 && scope[i - 1] != NEWLINE)
+                    {
+                        scope.Insert(i, { &NEWLINE, 1 });
+
+                        namespaceScope.end++;
+                        i++;
+                    }
+
+                    const auto _scopesOpened = (scopesOpened > 0 ? scopesOpened - 1 : 0);//cuz it is SCOPE_CLOSE
+
+                    //tabs
+                    namespaceScope.end += InsertIndentation(i, _scopesOpened);
+
+                    scopesOpened--;
+                }
+                else if(currentChar == NEWLINE)
+                {
+                    wasNewLine = true;
+                }
+                else if(currentChar == WHITESPACE || currentChar == TAB)
+                {
+                    index charsCount = 0;
+                    while(scope[i + charsCount] == currentChar)
+                        charsCount++;
+
+                    scope.Erase(i, charsCount);
+
+                    namespaceScope.end -= charsCount;
+
+                    //unlike after whitespaces, the char right after tabs is copied without being looked at
+                    if(currentChar == WHITESPACE)
+                        increment = false;
+                }
+            }
+            else if(parsingDataType == ParsingDataType::Variable)
+            {
+                //newline
+                if(!wasNewLine && i > 0)
+                {
+                    scope.Insert(i, { &NEWLINE, 1 });
+
+                    namespaceScope.end++;
+                    i++;
+                }
+
+                //tabs
+                namespaceScope.end += InsertIndentation(i, scopesOpened);
+
+                VariableIndicesInfo variableIndices = ReceiveVariableInfo(scope.source, scope.sourcePosition);
+
+                {
+                    const index offset = scope.SourceOffset();
+
+                    variableIndices.type += offset;
+                    variableIndices.equals += offset;
+                    variableIndices.name += offset;
+                    if(variableIndices.value.IsValid())
+                        variableIndices.value += offset;
+                    variableIndices.semicolon += offset;
+                }
+
+                //checking for gaps
+                {
+                    bool incrementJ = true;
+
+                    for(index j = variableIndices.type.end + 1, extraCharsCount = 0; j <= variableIndices.semicolon;)
+                    {
+                        const char currentVariableChar = scope[j];
+
+                        if(currentVariableChar == WHITESPACE || currentVariableChar == TAB)
+                            extraCharsCount++;
+                        else
+                        {
+                            if(extraCharsCount > ACCEPTABLE_WHITESPACES_COUNT)
+                            {
+                                const index extraCharsCountToDelete = extraCharsCount - 1;
+
+                                scope.Erase(j - extraCharsCount, extraCharsCountToDelete);
+
+                                namespaceScope.end -= extraCharsCountToDelete;
+
+                                if(j == variableIndices.name.begin)
+                                {
+                                    variableIndices.name -= extraCharsCountToDelete;
+                                    variableIndices.equals -= extraCharsCountToDelete;
+                                    variableIndices.value -= extraCharsCountToDelete;
+                                    variableIndices.semicolon -= extraCharsCountToDelete;
+
+                                    j = variableIndices.name.end + 1;
+                                }
+                                else if(j == variableIndices.equals)
+                                {
+                                    variableIndices.equals -= extraCharsCountToDelete;
+                                    variableIndices.value -= extraCharsCountToDelete;
+                                    variableIndices.semicolon -= extraCharsCountToDelete;
+
+                                    j = variableIndices.equals + 1;
+                                }
+                                else if(j == variableIndices.value.begin)
+                                {
+                                    variableIndices.value -= extraCharsCountToDelete;
+                                    variableIndices.semicolon -= extraCharsCountToDelete;
+
+                                    j = variableIndices.value.end;
+                                }
+                                else if(j == variableIndices.semicolon)
+                                {
+                                    variableIndices.semicolon -= extraCharsCountToDelete;
+
+                                    break;
+                                }
+
+                                incrementJ = false;
+                            }
+
+                            extraCharsCount = 0;
+                        }
+
+                        if(!incrementJ)
+                            incrementJ = true;
+                        else
+                            j++;
+                    }
+                }
+
+                i = variableIndices.semicolon + 1;
+
+                increment = false;
+
+                wasNewLine = false;
+            }
+            else if(parsingDataType == ParsingDataType::Namespace)
+            {
+                //newline
+                if(!wasNewLine && i > 0)
+                {
+                    scope.Insert(i, { &NEWLINE, 1 });
+
+                    namespaceScope.end++;
+                    i++;
+                }
+
+                //tabs
+                namespaceScope.end += InsertIndentation(i, scopesOpened);
+
+                NamespaceIndicesInfo namespaceIndices = ReceiveNamespaceInfo(scope.source, scope.sourcePosition);
+                namespaceIndices += scope.SourceOffset();
+
+                //checking for gaps
+                {
+                    bool incrementJ = true;
+                    bool wasNewLineBetweenNamespaceTokens = false;
+
+                    for(index j = namespaceIndices.keyword.end + 1, extraCharsCount = 0; j <= namespaceIndices.scope.begin;)
+                    {
+                        const char currentVariableChar = scope[j];
+
+                        if(currentVariableChar == WHITESPACE || currentVariableChar == TAB)
+                            extraCharsCount++;
+                        else
+                        {
+                            if(j > namespaceIndices.name.end && j < namespaceIndices.scope.begin && currentVariableChar == NEWLINE)
+                                wasNewLineBetweenNamespaceTokens = true;
+
+                            if(extraCharsCount > ACCEPTABLE_WHITESPACES_COUNT)
+                            {
+                                const index extraCharsCountToDelete = extraCharsCount;
+
+                                scope.Erase(j - extraCharsCount, extraCharsCountToDelete);
+
+                                namespaceScope.end -= extraCharsCountToDelete;
+
+                                if(j == namespaceIndices.name.begin)
+                                {
+                                    namespaceIndices.name -= extraCharsCountToDelete;
+                                    namespaceIndices.scope -= extraCharsCountToDelete;
+
+                                    j = namespaceIndices.name.end + 1;
+                                }
+                                else if(j == namespaceIndices.scope.begin)
+                                {
+                                    namespaceIndices.scope -= extraCharsCountToDelete;
+
+                                    break;
+                                }
+
+                                incrementJ = false;
+                            }
+
+                            extraCharsCount = 0;
+                        }
+
+                        if(!incrementJ)
+                            incrementJ = true;
+                        else
+                            j++;
+                    }
+
+                    wasNewLine = wasNewLineBetweenNamespaceTokens;
+                }
+
+                const index beforeScopeBegin = namespaceIndices.scope.begin;
+                const index beforeScopeEnd = namespaceIndices.scope.end;
+
+                i = FormatScope(scope, namespaceIndices.scope, scopesOpened, wasNewLine);
+
+                namespaceScope.begin += namespaceIndices.scope.begin - beforeScopeBegin;
+                namespaceScope.end += namespaceIndices.scope.end - beforeScopeEnd;
+
+                increment = false;
+
+                wasNewLine = false;
+            }
+
+            if(!increment)
+                increment = true;
+            else
+                i++;
+        }
+
+        return namespaceScope.end + (namespaceScope.end < static_cast<index>(scope.Size()) - 1);
+    }
+
+    ConfigFile::Parser::StringRange ConfigFile::Parser::CorrectStringRange(index scopeEnd, StringRange stringRange)
+    {
+        if(stringRange.begin == std::string::npos)
+            stringRange.begin = 0;
+        if(stringRange.end == std::string::npos)
+            stringRange.end = scopeEnd;
+
+        return stringRange;
+    }
+
+    ConfigFile::Parser::StringRange ConfigFile::Parser::CorrectStringRange(const std::string_view& scope, const StringRange& stringRange)
+    {
+        return CorrectStringRange((scope.empty() ? 0 : scope.size() - 1), stringRange);
+    }
+
+    bool ConfigFile::Parser::IsSpecialChar(char ch) noexcept
+    {
+        static constexpr std::array<bool, 256> specialChars = []
+            {
+                std::array<bool, 256> result{};
+
+                for(char specialChar : SPECIAL_CHARS)
+                    result[static_cast<unsigned char>(specialChar)] = true;
+
+                return result;
+            }();
+
+        return specialChars[static_cast<unsigned char>(ch)];
+    }
+
+    std::string ConfigFile::Parser::AddSpecialChars(std::string variableValue)
+    {
+        const size_t specialCharsCount = std::ranges::count_if(variableValue, IsSpecialChar);
+
+        if(specialCharsCount == 0)
+            return variableValue;
+
+        std::string result(variableValue.size() + specialCharsCount, SPECIAL_CHAR_SIGN);
+
+        size_t j = 0;
+        for(char currentChar : variableValue)
+        {
+            if(IsSpecialChar(currentChar))
+                j++;//SPECIAL_CHAR_SIGN is already there
+
+            result[j++] = currentChar;
+        }
+
+        return result;
+    }
+    std::string ConfigFile::Parser::RemoveSpecialChars(const std::string_view& variableValue)
+    {
+        std::string result(variableValue.size(), '\0');
+
+        result.resize(RemoveSpecialChars(variableValue, result.data()));
+
+        return result;
+    }
+    size_t ConfigFile::Parser::RemoveSpecialChars(const std::string_view& variableValue, char* output)
+    {
+        const size_t size = variableValue.size();
+
+        size_t j = 0;
+        for(size_t i = 0; i < size; i++)
+        {
+            const char currentChar = variableValue[i];
+
+            //SPECIAL_CHAR_SIGN before a special char is dropped, any other one is kept
+            if(currentChar == SPECIAL_CHAR_SIGN && i + 1 < size && IsSpecialChar(variableValue[i + 1]))
+                i++;
+
+            output[j++] = variableValue[i];
+        }
+
+        return j;
+    }
+
+    size_t ConfigFile::Parser::DetermineReserveSize(const Variable& variable)
+    {
+        size_t result = 0;
+
+        result += DataTypeToString(variable.GetType()).size();
+
+        result += variable.GetName().size();
+
+        result += 2;//VARIABLE_VALUE_SCOPE or SCOPE_OPEN, SCOPE_CLOSE
+
+        result += variable.GetRawValue().size();
+
+        result += 3;//WHITESPACEs
+
+        result += 1;//SEMICOLON
+
+        return result;
+    }
+
+    ConfigFile::Parser::ParsingDataType ConfigFile::Parser::DetermineParsingDataType(const std::string_view& scope, index currentCharIndex, bool& wasCommentScopeClosed, bool& wasValueScopeClosed)
+    {
+        const bool isEscaped = currentCharIndex == 0 || scope[currentCharIndex - 1] == SPECIAL_CHAR_SIGN;
+
+        return DetermineParsingDataType(scope, currentCharIndex, isEscaped, wasCommentScopeClosed, wasValueScopeClosed);
+    }
+    ConfigFile::Parser::ParsingDataType ConfigFile::Parser::DetermineParsingDataType(const std::string_view& scope, index currentCharIndex, bool isEscaped, bool& wasCommentScopeClosed, bool& wasValueScopeClosed)
+    {
+        char currentChar = scope[currentCharIndex];
+
+        if(currentChar == NEWLINE)
+            wasCommentScopeClosed = true;
+        else if(!wasCommentScopeClosed || IsFullSubstringSame(scope, currentCharIndex, COMMENT_SCOPE_LINE))
+        {
+            wasCommentScopeClosed = false;
+            return ParsingDataType::Comment;
+        }
+        else
+        {
+            if(currentChar == VARIABLE_VALUE_SCOPE)
+            {
+                if(!wasValueScopeClosed && !isEscaped)
+                    wasValueScopeClosed = true;
+                else
+                {
+                    wasValueScopeClosed = false;
+                    return ParsingDataType::VariableValue;
+                }
+            }
+            else if(wasValueScopeClosed)
+            {
+                if(IsFullSubstringSame(scope, currentCharIndex, NAMESPACE_KEYWORD))
+                    return ParsingDataType::Namespace;
+                else if(Variable::IsValidVariableChar(currentChar))
+                    return ParsingDataType::Variable;
+            }
+        }
+
+        return ParsingDataType::Invalid;
+    }
+
+    bool ConfigFile::Parser::IsArray(const std::string_view& variableValue)
+    {
+        if(variableValue.empty())
+            return false;
+
+        bool isArray = true;
+
+        if(variableValue[0] != SCOPE_OPEN)
+            isArray = false;
+        if(isArray && variableValue[variableValue.size() - 1] != SCOPE_CLOSE)
+            isArray = false;
+
+        if(isArray)
+        {
+            bool valueScopeClosed = true;
+            for(index i = 1; i < variableValue.size(); i++)
+            {
+                const char currentChar = variableValue[i];
+
+                if(currentChar == VARIABLE_VALUE_SCOPE && variableValue[i - 1] != SPECIAL_CHAR_SIGN)
+                    valueScopeClosed = !valueScopeClosed;
+            }
+
+            isArray = valueScopeClosed;
+        }
+
+        return isArray;
+    }
+}
+//ConfigFile::Parser's indices stuff
+namespace GuelderResourcesManager
+{
+
+    ConfigFile::Parser::StringRange::StringRange(index begin, index end)
+        : begin(begin), end(end)
+    {
+        if(begin > end)
+            throw std::invalid_argument{ "begin cannot be bigger than end" };
+    }
+
+    bool ConfigFile::Parser::StringRange::IsValid() const noexcept
+    {
+        return begin != std::string::npos && end != std::string::npos;
+    }
+
+    ConfigFile::Parser::StringRange& ConfigFile::Parser::StringRange::operator+=(index offset)
+    {
+        begin += offset;
+        end += offset;
+
+        return *this;
+    }
+
+    ConfigFile::Parser::StringRange& ConfigFile::Parser::StringRange::operator-=(index offset)
+    {
+        begin -= offset;
+        end -= offset;
+
+        return *this;
+    }
+
+    ConfigFile::Parser::NamespaceIndicesInfo& ConfigFile::Parser::NamespaceIndicesInfo::operator+=(index offset)
+    {
+        keyword += offset;
+        name += offset;
+        scope += offset;
+
+        return *this;
+    }
+
+    ConfigFile::Parser::StringRange operator+(const ConfigFile::Parser::StringRange& lhs, const ConfigFile::Parser::StringRange& rhs)
+    {
+        return { lhs.begin + rhs.begin, lhs.end + rhs.end };
+    }
+    ConfigFile::Parser::StringRange operator+(const ConfigFile::Parser::StringRange& lhs, ConfigFile::Parser::index rhs)
+    {
+        return { lhs.begin + rhs, lhs.end + rhs };
+    }
+
+    ConfigFile::Parser::NamespaceIndicesInfo operator+(const ConfigFile::Parser::NamespaceIndicesInfo& lhs, const ConfigFile::Parser::NamespaceIndicesInfo& rhs)
+    {
+        return
+        {
+            lhs.keyword + rhs.keyword,
+            lhs.name + rhs.name,
+            lhs.scope + rhs.scope,
+        };
+    }
+    ConfigFile::Parser::NamespaceIndicesInfo operator+(const ConfigFile::Parser::NamespaceIndicesInfo& lhs, ConfigFile::Parser::index rhs)
+    {
+        return
+        {
+            lhs.keyword + rhs,
+            lhs.name + rhs,
+            lhs.scope + rhs,
+        };
+    }
+
+    ConfigFile::Parser::VariableIndicesInfo operator+(const ConfigFile::Parser::VariableIndicesInfo& lhs, const ConfigFile::Parser::VariableIndicesInfo& rhs)
+    {
+        return
+        {
+            lhs.type + rhs.type,
+            lhs.equals + rhs.equals,
+            lhs.name + rhs.name,
+            lhs.value + rhs.value,
+            lhs.semicolon + rhs.semicolon
+        };
+    }
+    ConfigFile::Parser::VariableIndicesInfo operator+(const ConfigFile::Parser::VariableIndicesInfo& lhs, ConfigFile::Parser::index rhs)
+    {
         return
         {
-            {variableTypeBeginIndex, variableTypeEndIndex},
-            equalsIndex,
-            {variableNameBeginIndex, variableNameEndIndex},
-            {variableValueBeginIndex, variableValueEndIndex},
-            variableValueSemicolon,
-            isArray
+            lhs.type + rhs,
+            lhs.equals + rhs,
+            lhs.name + rhs,
+            lhs.value + rhs,
+            lhs.semicolon + rhs
         };
     }
-
-    ConfigFile::Parser::NamespaceIndicesInfo ConfigFile::Parser::FindNamespace(const std::string_view& scope, const std::string_view& path)
+}
+//ResourcesManager
+namespace GuelderResourcesManager
+{
+    ResourcesManager::ResourcesManager(std::filesystem::path executablePath)
+        : m_Path(std::move(executablePath))
     {
-        if(path.empty())
-            throw std::invalid_argument{ "namespace path is empty" };
-
-        bool isCommentScopeClosed = true;
-        bool isValueScopeClosed = true;
+        m_Path.remove_filename();
+    }
 
-        for(index i = 0; i < scope.size(); i++)
+#ifndef WIN32
+    namespace
+    {
+        //reads until EOF, sizeHint is only used to reserve
+        std::string ReadFileDescriptor(int fileDescriptor, size_t sizeHint, const std::filesystem::path& filePath)
         {
-            const ParsingDataType parsingDataType = DetermineParsingDataType(scope, i, isCommentScopeClosed, isValueScopeClosed);
+            constexpr size_t MIN_READ_SIZE = 64 * 1024;
 
-            if(parsingDataType == ParsingDataType::Namespace)
-            {
-                const NamespaceIndicesInfo namespaceIndicesInfo = ReceiveNamespaceInfo(scope, i);
+            std::string result;
+            //+ 1 so EOF of a regular file is reached without growing the buffer
+            result.resize(std::max(sizeHint + 1, MIN_READ_SIZE));
 
-                //const std::string_view foundNamespaceName{ scope.cbegin() + namespaceIndicesInfo.nameBegin, scope.cbegin() + namespaceIndicesInfo.nameEnd + 1 };
-                const std::string_view foundNamespaceName = namespaceIndicesInfo.name.GetSubstring<std::string_view>(scope);
+            size_t readSize = 0;
 
-                const index pathSeparatorIndex = path.find('/');
+            while(true)
+            {
+                if(readSize == result.size())
+                    result.resize(result.size() * 2);
 
-                //current namespace path name so namespace1/namespace2/namespace3
-                //                               ^ starts from the beginning, cuz you need to think
-                const std::string_view currentPath{ path.cbegin(), path.cbegin() + (pathSeparatorIndex == std::string::npos ? path.size() : pathSeparatorIndex) };
+                const ssize_t bytesRead = read(fileDescriptor, result.data() + readSize, result.size() - readSize);
 
-                if(currentPath == foundNamespaceName)
+                if(bytesRead == 0)
+                    break;
+                if(bytesRead < 0)
                 {
-                    if(pathSeparatorIndex == std::string::npos)
-                        return namespaceIndicesInfo;
-                    else
-                    {
-                        //but there could be multiple namespaces with the same name
-                        const std::string_view nextPath{ path.cbegin() + currentPath.size() + 1, path.cend() };
-
-                        //const std::string_view nextScope{ scope.cbegin() + namespaceIndicesInfo.scopeBegin, scope.cbegin() + namespaceIndicesInfo.scopeEnd };
-                        const std::string_view nextScope = namespaceIndicesInfo.scope.GetSubstring<std::string_view>(scope);
+                    if(errno == EINTR)
+                        continue;
 
-                        //wtf is wrong with returning indices?
-                        auto n = FindNamespace(nextScope, nextPath);
-
-                        return n + namespaceIndicesInfo.scope.begin;
-                    }
+                    throw std::filesystem::filesystem_error{ "Failed to read file", filePath, std::error_code{ errno, std::generic_category() } };
                 }
 
-                i = namespaceIndicesInfo.scope.end;
+                readSize += bytesRead;
             }
-        }
-
-        throw std::out_of_range{ "Failed to find namespace" };
-    }
 
-    ConfigFile::Parser::VariableIndicesInfo ConfigFile::Parser::FindVariableInfo(const std::string_view& scope, const std::string_view& path)
-    {
-        const index lastPathSeparatorIndex = path.find_last_of('/');
+            result.resize(readSize);
 
-        const std::string_view namespacePath = (lastPathSeparatorIndex == std::string::npos ? "" : std::string_view{ path.cbegin(), path.cbegin() + lastPathSeparatorIndex });
-        const std::string_view toFindVariableName{ path.cbegin() + (lastPathSeparatorIndex == std::string::npos ? 0 : lastPathSeparatorIndex + 1), path.cend() };
+            return result;
+        }
 
-        if(lastPathSeparatorIndex == std::string::npos)
+        struct FileDescriptor
         {
-            bool isCommentScopeClosed = true;
-            bool isValueScopeClosed = true;
-
-            for(index j = 0; j < scope.size(); j++)
+            FileDescriptor(const std::filesystem::path& filePath, int flags = O_RDONLY | O_CLOEXEC)
+                : fileDescriptor(open(filePath.c_str(), flags))
             {
-                const ParsingDataType parsingDataType = DetermineParsingDataType(scope, j, isCommentScopeClosed, isValueScopeClosed);
-
-                if(parsingDataType == ParsingDataType::Variable)
-                {
-                    const VariableIndicesInfo variableInfo = ReceiveVariableInfo(scope, j);
-
-                    const std::string_view variableName = variableInfo.name.GetSubstring<std::string_view>(scope);
+                if(fileDescriptor < 0)
+                    throw std::filesystem::filesystem_error{ "Failed to open file", filePath, std::error_code{ errno, std::generic_category() } };
+            }
+            //takes the ownership
+            explicit FileDescriptor(int fileDescriptor)
+                : fileDescriptor(fileDescriptor) {
+            }
+            ~FileDescriptor()
+            {
+                close(fileDescriptor);
+            }
 
-                    if(variableName == toFindVariableName)
-                        return variableInfo;
+            FileDescriptor(const FileDescriptor& other) = delete;
+            FileDescriptor& operator=(const FileDescriptor& other) = delete;
 
-                    j = variableInfo.semicolon + 1;
-                }
-                else if(parsingDataType == ParsingDataType::Namespace)
-                {
-                    const NamespaceIndicesInfo namespaceInfo = ReceiveNamespaceInfo(scope, j);
+            int fileDescriptor;
+        };
 
-                    j = namespaceInfo.scope.end;
-                }
-            }
-        }
-        else
+        void WriteFileDescriptor(int fileDescriptor, const std::string_view& content, const std::filesystem::path& filePath)
         {
-            std::string_view nextScope{ scope };
-            index offset = 0;
-
-            for(NamespaceIndicesInfo namespaceInfo = FindNamespace(nextScope, namespacePath); namespaceInfo.scope.end < scope.size(); namespaceInfo = FindNamespace(nextScope, namespacePath))
+            for(size_t writtenSize = 0; writtenSize < content.size();)
             {
-                const std::string_view namespaceScope = namespaceInfo.scope.GetSubstring<std::string_view>(nextScope);
-
-                bool isCommentScopeClosed = true;
-                bool isValueScopeClosed = true;
+                const ssize_t bytesWritten = write(fileDescriptor, content.data() + writtenSize, content.size() - writtenSize);
 
-                for(index j = 0; j < namespaceScope.size(); j++)
+                if(bytesWritten < 0)
                 {
-                    const ParsingDataType parsingDataType = DetermineParsingDataType(namespaceScope, j, isCommentScopeClosed, isValueScopeClosed);
-
-                    if(parsingDataType == ParsingDataType::Variable)
-                    {
-                        const VariableIndicesInfo variableInfo = ReceiveVariableInfo(namespaceScope, j);
-
-                        const std::string_view variableName = variableInfo.name.GetSubstring<std::string_view>(namespaceScope);
-
-                        if(variableName == toFindVariableName)
-                            return variableInfo + offset + namespaceInfo.scope.begin;
+                    if(errno == EINTR)
+                        continue;
 
-                        j = variableInfo.semicolon + 1;
-                    }
+                    throw std::filesystem::filesystem_error{ "Failed to write file", filePath, std::error_code{ errno, std::generic_category() } };
                 }
 
-                nextScope = std::string_view{ nextScope.cbegin() + namespaceInfo.scope.end + 1, nextScope.cend() };
-                offset += namespaceInfo.scope.end + 1;
+                writtenSize += bytesWritten;
             }
         }
 
-        throw std::out_of_range{ "failed to find variable" };
-    }
-    Variable ConfigFile::Parser::FindVariable(const std::string_view& scope, const std::string_view& path)
-    {
-        const VariableIndicesInfo info = FindVariableInfo(scope, path);
+        //creates a new file next to targetPath, which is not visible to the readers of targetPath
+        int CreateTemporaryFile(const std::filesystem::path& targetPath, std::filesystem::path& temporaryPath)
+        {
+            static std::atomic<uint32_t> temporaryFilesCount = 0;
 
-        const std::string_view variableValueRaw = info.value.GetSubstring<std::string_view>(scope);
-        std::string variableValue{ variableValueRaw };
+            constexpr uint32_t MAX_ATTEMPTS = 100;
 
-        for(char specialChar : SPECIAL_CHARS)
-            for(index j = 0; j < variableValue.size(); j++)
-                if(j > 0 && variableValue[j] == specialChar && variableValue[j - 1] == SPECIAL_CHAR_SIGN)
-                    variableValue.erase(j - 1, 1);
+            for(uint32_t i = 0; i < MAX_ATTEMPTS; i++)
+            {
+                temporaryPath = targetPath;
+                temporaryPath += std::format(".{}.{}.tmp", getpid(), temporaryFilesCount++);
 
-        return Variable{ path.data(), std::move(variableValue), StringToDataType(info.type.GetSubstring<std::string_view>(scope)), IsArray(variableValueRaw) };
-    }
+                //0666 so the umask is applied, as for a file created by std::ofstream
+                const int fileDescriptor = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
 
-    void AddChar(std::stringstream& ss, char ch, size_t amount = 1)
-    {
-        for(size_t i = 0; i < amount; i++)
-            ss << ch;
+                if(fileDescriptor >= 0)
+                    return fileDescriptor;
+                if(errno != EEXIST)
+                    throw std::filesystem::filesystem_error{ "Failed to create temporary file", temporaryPath, std::error_code{ errno, std::generic_category() } };
+            }
+
+            throw std::filesystem::filesystem_error{ "Failed to create temporary file", targetPath, std::make_error_code(std::errc::file_exists) };
+        }
     }
+#endif
 
-    std::string ConfigFile::Parser::WriteVariable(std::string scope, const Variable& variable, StringRange scopeRange)
+    ResourcesManager::MappedFile::MappedFile(const std::filesystem::path& filePath)
+        : m_MappedData(nullptr), m_MappedSize(0)
     {
-        bool doesScopeExist = true;
-
-        const std::string_view path = variable.GetPath();
+#ifndef WIN32
+        const FileDescriptor file{ filePath };
 
-        index prevPathSeparatorOffset;
-        index pathSeparatorOffset = path.find(PATH_SEPARATOR);
-
-        std::string_view currentNamespace;
-
-        std::string_view currentScope;
-        index insertOffset;
-
-        scopeRange = CorrectStringRange(scope, scopeRange);
-        insertOffset = scopeRange.begin;
-
-        currentScope = scopeRange.GetSubstring<std::string_view>(scope);
-
-        /*if(scopeRange.IsValid())
-        {
-            insertOffset = scopeRange.begin;
-            currentScope = scopeRange.GetSubstring<std::string_view>(scope);
-        }
-        else
-        {
-            insertOffset = 0;
-            currentScope = scope;
-        }*/
+        struct stat fileStat{};
+        if(fstat(file.fileDescriptor, &fileStat) != 0)
+            throw std::filesystem::filesystem_error{ "Failed to receive file info", filePath, std::error_code{ errno, std::generic_category() } };
 
-        //finding the scope wee need
-        //if(scopeRange.IsValid() && scopeRange.begin == scopeRange.end)
-        if(scopeRange.begin == scopeRange.end)
+        //pipes, sockets and files like /proc/* don't have a real size, so they cannot be mapped
+        if(S_ISREG(fileStat.st_mode) && fileStat.st_size > 0)
         {
-            const index pathSeparatorIndex = path.find(PATH_SEPARATOR);
+            void* mappedData = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, file.fileDescriptor, 0);
 
-            if(pathSeparatorIndex != std::string::npos)
+            if(mappedData != MAP_FAILED)
             {
-                doesScopeExist = false;
+                madvise(mappedData, fileStat.st_size, MADV_SEQUENTIAL);
 
-                currentNamespace = { path.cbegin(), path.cbegin() + pathSeparatorIndex };
-            }
+                m_MappedData = static_cast<const char*>(mappedData);
+                m_MappedSize = fileStat.st_size;
 
+                return;
+            }
         }
-        else
-        {
-            index localNamespaceSize = 0;
-            //for debug only
-            NamespaceIndicesInfo namespaceIndicesInfo;
-            try
-            {
-                //std::vector<std::string_view> dbgs;
-                for(prevPathSeparatorOffset = 0; pathSeparatorOffset != std::string::npos; prevPathSeparatorOffset = pathSeparatorOffset + 1, pathSeparatorOffset = path.find(PATH_SEPARATOR, prevPathSeparatorOffset))
-                {
-                    currentNamespace = { path.cbegin() + prevPathSeparatorOffset, path.cbegin() + pathSeparatorOffset };
 
-                    //NamespaceIndicesInfo namespaceIndicesInfo = FindNamespace(currentScope, currentNamespace);
-                    namespaceIndicesInfo = FindNamespace(currentScope, currentNamespace);
+        m_Buffer = ReadFileDescriptor(file.fileDescriptor, S_ISREG(fileStat.st_mode) ? fileStat.st_size : 0, filePath);
+#else
+        const HANDLE fileHandle = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
 
-                    localNamespaceSize = namespaceIndicesInfo.scope.end - namespaceIndicesInfo.scope.begin;
+        if(fileHandle == INVALID_HANDLE_VALUE)
+            throw std::filesystem::filesystem_error{ "Failed to open file", filePath, std::error_code{ static_cast<int>(GetLastError()), std::system_category() } };
 
-                    currentScope = namespaceIndicesInfo.scope.GetSubstring<std::string_view>(currentScope);
-                    insertOffset += namespaceIndicesInfo.scope.begin;
+        Handle file{ fileHandle };
 
-                    //dbgs.push_back(currentScope);
-                }
-            }
-            catch(...)
-            {
-                doesScopeExist = false;
-            }
+        LARGE_INTEGER fileSize{};
 
-            if(localNamespaceSize > 0)
-                //TODO: this is wrong
-                insertOffset += localNamespaceSize - 1;
+        //pipes and devices are not disk files, so they cannot be mapped
+        if(GetFileType(file) == FILE_TYPE_DISK && GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+        {
+            //the view keeps the mapping alive after its handle is closed
+            Handle mapping{ CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr) };
 
-            //check for comments offset
-            //error here i is too big
-            if(!insertOffset)
-            {
-                bool isCommented = false;
-                for(index& i = insertOffset; i < currentScope.size(); i++)
+            if(mapping.handle)
+                if(const void* mappedData = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0))
                 {
-                    const char currentChar = currentScope[i];
-
-                    if(isCommented && currentChar == NEWLINE)
-                    {
-                        //insertOffset = i;
-
-                        isCommented = false;
-                        break;
-                    }
-                    else if(!isCommented)
-                    {
-                        if(IsFullSubstringSame(currentScope, i, COMMENT_SCOPE_LINE))
-                        {
-                            isCommented = true;
-                            i += COMMENT_SCOPE_LINE.size() - 1;
+                    m_MappedData = static_cast<const char*>(mappedData);
+                    m_MappedSize = static_cast<size_t>(fileSize.QuadPart);
 
-                            //insertOffset = i;
-                        }
-                    }
+                    return;
                 }
-            }
         }
 
-        if(doesScopeExist)
-        {
-            std::stringstream variableToInsertStringStream;
+        m_Buffer = ReceiveFileSource(filePath);
+#endif
+    }
+    ResourcesManager::MappedFile::~MappedFile()
+    {
+        Unmap();
+    }
 
-            variableToInsertStringStream << DataTypeToString(variable.GetType()) << ' ' << variable.GetName() << ' ' << EQUALS << ' ';
-            if(variable.IsArray())
-                variableToInsertStringStream << SCOPE_OPEN << variable.GetRawValue() << SCOPE_CLOSE;
-            else
-                variableToInsertStringStream << VARIABLE_VALUE_SCOPE << variable.GetRawValue() << VARIABLE_VALUE_SCOPE;
+    ResourcesManager::MappedFile::MappedFile(MappedFile&& other) noexcept
+        : m_MappedData(other.m_MappedData), m_MappedSize(other.m_MappedSize), m_Buffer(std::move(other.m_Buffer))
+    {
+        other.m_MappedData = nullptr;
+        other.m_MappedSize = 0;
+    }
+    ResourcesManager::MappedFile& ResourcesManager::MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if(this != &other)
+        {
+            Unmap();
 
-            variableToInsertStringStream << SEMICOLON;
+            m_MappedData = other.m_MappedData;
+            m_MappedSize = other.m_MappedSize;
+            m_Buffer = std::move(other.m_Buffer);
 
-            const bool add = insertOffset == scope.size() || !insertOffset ? false : !scope.empty();
-            //ahhh... copying
-            scope.insert(insertOffset + add, variableToInsertStringStream.str());
+            other.m_MappedData = nullptr;
+            other.m_MappedSize = 0;
         }
-        else
-        {
-            //the scope doesn't exist, so we need to create it
-            std::stringstream newScope;
-
-            size_t scopesOpenedCount = 0;
 
-            for(prevPathSeparatorOffset = pathSeparatorOffset + 1, pathSeparatorOffset = path.find(PATH_SEPARATOR, prevPathSeparatorOffset); true; prevPathSeparatorOffset = pathSeparatorOffset + 1, pathSeparatorOffset = path.find(PATH_SEPARATOR, prevPathSeparatorOffset))
-            {
-                scopesOpenedCount++;
+        return *this;
+    }
 
-                newScope << NAMESPACE_KEYWORD << ' ' << currentNamespace << SCOPE_OPEN;
+    std::string_view ResourcesManager::MappedFile::GetSource() const noexcept
+    {
+        return IsMapped() ? std::string_view{ m_MappedData, m_MappedSize } : std::string_view{ m_Buffer };
+    }
+    bool ResourcesManager::MappedFile::IsMapped() const noexcept
+    {
+        return m_MappedData != nullptr;
+    }
 
-                if(pathSeparatorOffset == std::string::npos)
-                    break;
+    void ResourcesManager::MappedFile::Unmap() noexcept
+    {
+        if(m_MappedData)
+#ifndef WIN32
+            munmap(const_cast<char*>(m_MappedData), m_MappedSize);
+#else
+            UnmapViewOfFile(m_MappedData);
+#endif
+
+        m_MappedData = nullptr;
+        m_MappedSize = 0;
+    }
 
-                currentNamespace = { path.cbegin() + prevPathSeparatorOffset, path.cbegin() + pathSeparatorOffset };
-            }
+    std::string ResourcesManager::ReceiveFileSource(const std::filesystem::path& filePath)
+    {
+#ifndef WIN32
+        //straight into the result, without going through stream buffers
+        const FileDescriptor file{ filePath };
 
-            newScope << DataTypeToString(variable.GetType()) << ' ' << variable.GetName() << ' ' << EQUALS << ' ';
-            if(variable.IsArray())
-                newScope << SCOPE_OPEN << variable.GetRawValue() << SCOPE_CLOSE;
-            else
-                newScope << VARIABLE_VALUE_SCOPE << variable.GetRawValue() << VARIABLE_VALUE_SCOPE;
+        struct stat fileStat{};
+        if(fstat(file.fileDescriptor, &fileStat) != 0)
+            throw std::filesystem::filesystem_error{ "Failed to receive file info", filePath, std::error_code{ errno, std::generic_category() } };
 
-            newScope << SEMICOLON;
+        return ReadFileDescriptor(file.fileDescriptor, S_ISREG(fileStat.st_mode) ? fileStat.st_size : 0, filePath);
+#else
+        std::ifstream file;
+        file.exceptions(std::ios::failbit | std::ios::badbit);
 
-            AddChar(newScope, SCOPE_CLOSE, scopesOpenedCount);
+        file.open(filePath, std::ios::binary);
 
-            const bool add = insertOffset == scope.size() ? false : !scope.empty();
-            //ahhh... copying
-            scope.insert(insertOffset + add, newScope.str());
-        }
+        std::stringstream source;//istringstream or stringstream?
+        source << file.rdbuf();
 
-        return scope;
+        file.close();
+
+        return source.str();
+#endif
     }
 
-    std::string ConfigFile::Parser::WriteVariables(std::string scope, const std::vector<Variable>& variables, StringRange scopeRange)
+    void ResourcesManager::AppendToFile(const std::filesystem::path& filePath, const std::string_view& append)
     {
-        size_t toReserve = 0;
+        std::ofstream file;
+        file.exceptions(std::ios::failbit | std::ios::badbit);
 
-        //also it is possible to do the same stuff for namespaces, but ...
-        for(auto&& variable : variables)
-            toReserve += DetermineReserveSize(variable);
+        file.open(filePath, std::ios::binary | std::ios::app);
 
-        scope.reserve(scope.size() + toReserve);
+        //file << append;
+        file.write(append.data(), append.size());
 
-        for(auto&& variable : variables)
+        file.close();
+    }
+    void ResourcesManager::WriteToFile(const std::filesystem::path& filePath, const std::string_view& content, SaveMode saveMode)
+    {
+        if(saveMode == SaveMode::InPlace)
         {
-            //bool dbgBool = IsFullSubstringSame(variable.GetName(), 0, "attachment0Path");
+            std::ofstream file;
+            file.exceptions(std::ios::failbit | std::ios::badbit);
 
-            scope = WriteVariable(std::move(scope), variable, scopeRange);
+            file.open(filePath, std::ios::binary);
+
+            file.write(content.data(), content.size());
+            //file << content;
+
+            file.close();
+
+            return;
         }
 
-        return scope;
-    }
+        //renaming over a symlink would replace the symlink itself
+        const std::filesystem::path targetPath = std::filesystem::is_symlink(filePath) ? std::filesystem::canonical(filePath) : filePath;
+
+#ifndef WIN32
+        std::filesystem::path temporaryPath;
 
-    //TODO:
-    std::string ConfigFile::Parser::WriteVariableAfter(std::string scope, const Variable& variable, const std::string_view& after, StringRange scopeRange)
-    {
-        scopeRange = CorrectStringRange(scope, scopeRange);
-        //std::string_view scopeView = scopeRange.IsValid() ? scopeRange.GetSubstring<std::string_view>(scope) : scope;
-        std::string_view scopeView = scopeRange.GetSubstring<std::string_view>(scope);
         try
         {
-            VariableIndicesInfo variableIndicesInfo = FindVariableInfo(scopeView, after);
+            //closed before the rename, so watchers of the directory don't see a write to the renamed file
+            {
+                const FileDescriptor file{ CreateTemporaryFile(targetPath, temporaryPath) };
 
-            return WriteVariable(std::move(scope), variable, StringRange{ variableIndicesInfo.semicolon, variableIndicesInfo.semicolon });
-            //return WriteVariable(std::move(scope), variable, (scopeRange.IsValid() ? StringRange{variableIndicesInfo.semicolon + 1, scopeRange.end} : StringRange{variableIndicesInfo.semicolon + 1, static_cast<index>(scope.size() - 1)}));
+                //the new file keeps the permissions of the original one
+                struct stat targetStat{};
+                if(stat(targetPath.c_str(), &targetStat) == 0 && fchmod(file.fileDescriptor, targetStat.st_mode & 07777) != 0)
+                    throw std::filesystem::filesystem_error{ "Failed to copy file permissions", temporaryPath, std::error_code{ errno, std::generic_category() } };
+
+                WriteFileDescriptor(file.fileDescriptor, content, temporaryPath);
+
+                if(saveMode == SaveMode::Durable && fsync(file.fileDescriptor) != 0)
+                    throw std::filesystem::filesystem_error{ "Failed to flush file", temporaryPath, std::error_code{ errno, std::generic_category() } };
+            }
+
+            if(rename(temporaryPath.c_str(), targetPath.c_str()) != 0)
+                throw std::filesystem::filesystem_error{ "Failed to replace file", temporaryPath, targetPath, std::error_code{ errno, std::generic_category() } };
         }
         catch(...)
         {
-            NamespaceIndicesInfo namespaceIndicesInfo = FindNamespace(scopeView, after);
+            if(!temporaryPath.empty())
+                unlink(temporaryPath.c_str());
 
-            return WriteVariable(std::move(scope), variable, StringRange{ namespaceIndicesInfo.scope.end, namespaceIndicesInfo.scope.end });
-            //return WriteVariable(std::move(scope), variable, (scopeRange.IsValid() ? StringRange{namespaceIndicesInfo.scope.end + 1, scopeRange.end} : StringRange{namespaceIndicesInfo.scope.end + 1, static_cast<index>(scope.size() - 1)}));
+            throw;
         }
-    }
-    std::string ConfigFile::Parser::WriteVariablesAfter(std::string scope, const std::vector<Variable>& variables, const std::string_view& after, StringRange scopeRange)
-    {
-        scopeRange = CorrectStringRange(scope, scopeRange);
-        //std::string_view scopeView = scopeRange.IsValid() ? scopeRange.GetSubstring<std::string_view>(scope) : scope;
-        std::string_view scopeView = scopeRange.GetSubstring<std::string_view>(scope);
-        try
-        {
-            VariableIndicesInfo variableIndicesInfo = FindVariableInfo(scopeView, after);
 
-            return WriteVariables(std::move(scope), variables, { variableIndicesInfo.semicolon, variableIndicesInfo.semicolon });
-            //return WriteVariables(std::move(scope), variables, (scopeRange.IsValid() ? StringRange{variableIndicesInfo.semicolon + 1, scopeRange.end} : StringRange{variableIndicesInfo.semicolon + 1, static_cast<index>(scope.size() - 1)}));
-        }
-        catch(...)
+        //the rename itself is durable only after the directory is flushed
+        if(saveMode == SaveMode::Durable)
         {
-            NamespaceIndicesInfo namespaceIndicesInfo = FindNamespace(scopeView, after);
+            const std::filesystem::path directoryPath = targetPath.has_parent_path() ? targetPath.parent_path() : std::filesystem::path{ "." };
+            const FileDescriptor directory{ directoryPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC };
 
-            return WriteVariables(std::move(scope), variables, { namespaceIndicesInfo.scope.end, namespaceIndicesInfo.scope.end });
-            //return WriteVariables(std::move(scope), variables, (scopeRange.IsValid() ? StringRange{namespaceIndicesInfo.scope.end + 1, scopeRange.end} : StringRange{namespaceIndicesInfo.scope.end + 1, static_cast<index>(scope.size() - 1)}));
+            if(fsync(directory.fileDescriptor) != 0)
+                throw std::filesystem::filesystem_error{ "Failed to flush directory", directoryPath, std::error_code{ errno, std::generic_category() } };
         }
-    }
-    std::string ConfigFile::Parser::WriteVariableBefore(std::string scope, const Variable& variable, const std::string_view& before, StringRange scopeRange)
-    {
-        scopeRange = CorrectStringRange(scope, scopeRange);
-        //std::string_view scopeView = scopeRange.IsValid() ? scopeRange.GetSubstring<std::string_view>(scope) : scope;
-        std::string_view scopeView = scopeRange.GetSubstring<std::string_view>(scope);
+#else
+        std::filesystem::path temporaryPath = targetPath;
+        temporaryPath += std::format(".{}.tmp", GetCurrentProcessId());
+
         try
         {
-            VariableIndicesInfo variableIndicesInfo = FindVariableInfo(scopeView, before);
+            std::ofstream file;
+            file.exceptions(std::ios::failbit | std::ios::badbit);
 
-            StringRange stringRange = { variableIndicesInfo.type.begin, variableIndicesInfo.type.begin };
-            if(stringRange.begin > 0)
-                stringRange += -1;
-            if(stringRange.begin > 0)
-                stringRange += -1;
+            file.open(temporaryPath, std::ios::binary);
 
-            return WriteVariable(std::move(scope), variable, stringRange);
+            file.write(content.data(), content.size());
+
+            file.close();
+
+            //MOVEFILE_WRITE_THROUGH returns only after the file is flushed to the disk
+            if(!MoveFileExW(temporaryPath.c_str(), targetPath.c_str(), MOVEFILE_REPLACE_EXISTING | (saveMode == SaveMode::Durable ? MOVEFILE_WRITE_THROUGH : 0)))
+                throw std::filesystem::filesystem_error{ "Failed to replace file", temporaryPath, targetPath, std::error_code{ static_cast<int>(GetLastError()), std::system_category() } };
         }
         catch(...)
         {
-            NamespaceIndicesInfo namespaceIndicesInfo = FindNamespace(scopeView, before);
-
-            StringRange stringRange = { namespaceIndicesInfo.keyword.begin, namespaceIndicesInfo.keyword.begin };
-            if(stringRange.begin > 0)
-                stringRange += -1;
-            if(stringRange.begin > 0)
-                stringRange += -1;
+            std::error_code errorCode;
+            std::filesystem::remove(temporaryPath, errorCode);
 
-            return WriteVariable(std::move(scope), variable, stringRange);
+            throw;
         }
+#endif
     }
-    std::string ConfigFile::Parser::WriteVariablesBefore(std::string scope, const std::vector<Variable>& variables, const std::string_view& before, StringRange scopeRange)
+    void ResourcesManager::WriteToFile(const std::filesystem::path& filePath, ConfigFile::Parser::index index, const std::string_view& content, SaveMode saveMode)
     {
-        scopeRange = CorrectStringRange(scope, scopeRange);
-        //std::string_view scopeView = scopeRange.IsValid() ? scopeRange.GetSubstring<std::string_view>(scope) : scope;
-        std::string_view scopeView = scopeRange.GetSubstring<std::string_view>(scope);
-        try
-        {
-            VariableIndicesInfo variableIndicesInfo = FindVariableInfo(scopeView, before);
+        std::string source = ReceiveFileSource(filePath);
 
-            return WriteVariables(std::move(scope), variables, (scopeRange.IsValid() ? StringRange{ scopeRange.begin, variableIndicesInfo.semicolon + 1 } : StringRange{ 0, variableIndicesInfo.semicolon + 1 }));
-        }
-        catch(...)
-        {
-            NamespaceIndicesInfo namespaceIndicesInfo = FindNamespace(scopeView, before);
+        source.insert(index, content);
 
-            return WriteVariables(std::move(scope), variables, (scopeRange.IsValid() ? StringRange{ scopeRange.begin, namespaceIndicesInfo.scope.end + 1 } : StringRange{ 0, namespaceIndicesInfo.scope.end + 1 }));
-        }
+        WriteToFile(filePath, source, saveMode);
     }
 
-    std::string ConfigFile::Parser::DeleteNamespace(std::string scope, const std::string_view& path)
+    namespace
     {
-        NamespaceIndicesInfo namespaceIndicesInfo = FindNamespace(scope, path);
+        constexpr size_t COMMAND_OUTPUT_READ_SIZE = 64 * 1024;
 
-        scope.erase(scope.cbegin() + namespaceIndicesInfo.keyword.begin, scope.cbegin() + namespaceIndicesInfo.scope.end + 1);
+        //splits the read chunks into lines if needed. Lines that are entirely in one chunk are not copied
+        struct OutputDispatcher
+        {
+            OutputDispatcher(const ResourcesManager::OutputCallback& callback, ResourcesManager::OutputMode outputMode)
+                : callback(callback), outputMode(outputMode) {
+            }
 
-        return scope;
-    }
-    std::string ConfigFile::Parser::DeleteVariable(std::string scope, const std::string_view& path)
-    {
-        VariableIndicesInfo variableIndicesInfo = FindVariableInfo(scope, path);
+            //returns false if the callback asked to stop
+            bool Dispatch(std::string_view chunk)
+            {
+                if(outputMode == ResourcesManager::OutputMode::Chunks)
+                    return callback(chunk);
 
-        scope.erase(scope.cbegin() + variableIndicesInfo.type.begin, scope.cbegin() + variableIndicesInfo.semicolon + 1);
+                for(size_t newlinePos; (newlinePos = chunk.find('\n')) != std::string_view::npos;)
+                {
+                    bool shouldContinue;
 
-        return scope;
+                    if(line.empty())
+                        shouldContinue = callback(chunk.substr(0, newlinePos));
+                    else
+                    {
+                        line.append(chunk.substr(0, newlinePos));
+                        shouldContinue = callback(line);
+                        line.clear();
+                    }
+
+                    chunk.remove_prefix(newlinePos + 1);
+
+                    if(!shouldContinue)
+                        return false;
+                }
+
+                line.append(chunk);
+
+                return true;
+            }
+            //the last line may not end with a newline
+            bool Finish()
+            {
+                return line.empty() || callback(line);
+            }
+
+            const ResourcesManager::OutputCallback& callback;
+            ResourcesManager::OutputMode outputMode;
+            std::string line;
+        };
     }
 
-    std::string ConfigFile::Parser::FormatScope(std::string scope, StringRange range)
+#ifndef WIN32
+    namespace
     {
-        /*if(!range.IsValid())
+        //whitespaces separate arguments, '"' and '\'' group them. '\\' escapes the next char outside of '\''
+        std::expected<std::vector<std::string>, std::string> SplitCommand(const std::string_view& command)
         {
-            range.begin = 0;
-            range.end = scope.size() - 1;
+            std::vector<std::string> arguments;
+            std::string argument;
+            //"" is an argument too
+            bool hasArgument = false;
+            char quote = '\0';
+
+            for(size_t i = 0; i < command.size(); i++)
+            {
+                const char ch = command[i];
+
+                if(quote != '\0')
+                {
+                    if(ch == quote)
+                        quote = '\0';
+                    else if(ch == '\\' && quote == '"' && i + 1 < command.size())
+                        argument += command[++i];
+                    else
+                        argument += ch;
+                }
+                else if(ch == '"' || ch == '\'')
+                {
+                    quote = ch;
+                    hasArgument = true;
+                }
+                else if(ch == '\\' && i + 1 < command.size())
+                {
+                    argument += command[++i];
+                    hasArgument = true;
+                }
+                else if(ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r')
+                {
+                    if(hasArgument)
+                    {
+                        arguments.push_back(std::move(argument));
+                        argument.clear();
+                        hasArgument = false;
+                    }
+                }
+                else
+                {
+                    argument += ch;
+                    hasArgument = true;
+                }
+            }
+
+            if(quote != '\0')
+                return std::unexpected{ std::format("Failed to execute command: unterminated quote in \"{}\".", command) };
+
+            if(hasArgument)
+                arguments.push_back(std::move(argument));
+
+            return arguments;
         }
-        if(!scope.empty() && range.end >= scope.size())
-            range.end = scope.size() - 1;
-        else if(scope.empty())
+
+        std::string ReceiveCommandErrorMessage(int error)
         {
-            range.begin = 0;
-            range.end = 0;
-        }*/
+            return std::format("Failed to execute command: {}.", std::generic_category().message(error));
+        }
 
-        range = CorrectStringRange(scope, range);
+        struct ChildProcess
+        {
+            pid_t processID;
+            //the read end of the child's stdout
+            int outputFileDescriptor;
+            //if true the child leads its own process group and the whole group is killed
+            bool isProcessGroup;
+        };
 
-        FormatScope(scope, range, 0);
+        //the child receives its end through dup2, which clears close-on-exec
+        int CreateCloseOnExecPipe(int(&pipeFileDescriptors)[2])
+        {
+#ifdef __linux__
+            return pipe2(pipeFileDescriptors, O_CLOEXEC) == 0 ? 0 : errno;
+#else
+            if(pipe(pipeFileDescriptors) != 0)
+                return errno;
 
-        return scope;
-    }
+            fcntl(pipeFileDescriptors[0], F_SETFD, FD_CLOEXEC);
+            fcntl(pipeFileDescriptors[1], F_SETFD, FD_CLOEXEC);
 
-    ConfigFile::Parser::index ConfigFile::Parser::FormatScope(std::string& scope, StringRange& namespaceScope, index scopesOpened, bool wasNewLine)
-    {
-        //temp
-        //static int c = 0;
-        //std::cout << c++ << '\n';
+            return 0;
+#endif
+        }
 
-        //auto dbg1 = namespaceScope.GetSubstring<std::string>(scope);
+        //the child's stdin is /dev/null and its stderr is inherited. Returns an errno value, 0 on success
+        int SpawnProcess(const std::vector<std::string>& arguments, bool isProcessGroup, ChildProcess& childProcess)
+        {
+            std::vector<char*> argv;
+            argv.reserve(arguments.size() + 1);
 
-        //temp end
+            for(const auto& argument : arguments)
+                argv.push_back(const_cast<char*>(argument.c_str()));
+            argv.push_back(nullptr);
 
-        constexpr size_t ACCEPTABLE_WHITESPACES_COUNT = 1;
-        constexpr size_t ACCEPTABLE_NEWLINES_COUNT = 1;
+            int pipeFileDescriptors[2];
+            if(const int error = CreateCloseOnExecPipe(pipeFileDescriptors); error != 0)
+                return error;
 
-        bool isCommentScopeClosed = true;
-        bool isValueScopeClosed = true;
+            posix_spawn_file_actions_t fileActions;
+            posix_spawn_file_actions_init(&fileActions);
+            posix_spawn_file_actions_addopen(&fileActions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+            posix_spawn_file_actions_adddup2(&fileActions, pipeFileDescriptors[1], STDOUT_FILENO);
 
-        bool increment = true;
-        index i;
-        for(i = namespaceScope.begin; i <= namespaceScope.end;)
+            //servers often ignore SIGPIPE and block signals in their threads, the child must not inherit that
+            posix_spawnattr_t attributes;
+            posix_spawnattr_init(&attributes);
+
+            sigset_t signals;
+            sigemptyset(&signals);
+            posix_spawnattr_setsigmask(&attributes, &signals);
+            sigaddset(&signals, SIGPIPE);
+            posix_spawnattr_setsigdefault(&attributes, &signals);
+
+            short flags = POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF;
+
+            if(isProcessGroup)
+            {
+                flags |= POSIX_SPAWN_SETPGROUP;
+                posix_spawnattr_setpgroup(&attributes, 0);
+            }
+
+            posix_spawnattr_setflags(&attributes, flags);
+
+            const int error = posix_spawnp(&childProcess.processID, argv[0], &fileActions, &attributes, argv.data(), environ);
+
+            posix_spawnattr_destroy(&attributes);
+            posix_spawn_file_actions_destroy(&fileActions);
+            close(pipeFileDescriptors[1]);
+
+            if(error != 0)
+            {
+                close(pipeFileDescriptors[0]);
+                return error;
+            }
+
+            childProcess.outputFileDescriptor = pipeFileDescriptors[0];
+            childProcess.isProcessGroup = isProcessGroup;
+
+            return 0;
+        }
+
+        std::expected<int, std::string> WaitForProcess(pid_t processID)
         {
-            const char currentChar = scope[i];
-            const ParsingDataType parsingDataType = DetermineParsingDataType(scope, i, isCommentScopeClosed, isValueScopeClosed);
+            int status = 0;
+
+            while(waitpid(processID, &status, 0) < 0)
+                if(errno != EINTR)
+                    return std::unexpected{ ReceiveCommandErrorMessage(errno) };
+
+            if(WIFSIGNALED(status))
+                return 128 + WTERMSIG(status);
+
+            return WEXITSTATUS(status);
+        }
+
+        //reads the output until EOF or until it is stopped, then kills the process if it was stopped and reaps it
+        std::expected<int, std::string> RunProcess(const ChildProcess& childProcess, OutputDispatcher& dispatcher, const std::stop_token& stopToken)
+        {
+            const pid_t killTarget = childProcess.isProcessGroup ? -childProcess.processID : childProcess.processID;
+
+            int readError = 0;
 
-            if(parsingDataType == ParsingDataType::Invalid)
             {
-                if(currentChar == SCOPE_OPEN)
+                const FileDescriptor output{ childProcess.outputFileDescriptor };
+
+                //the child is reaped only after the callback is destroyed, so its pid cannot be reused by then
+                const std::stop_callback stopCallback{ stopToken, [killTarget] { kill(killTarget, SIGKILL); } };
+
+                std::string buffer(COMMAND_OUTPUT_READ_SIZE, '\0');
+                bool isStopped = false;
+
+                while(!isStopped)
                 {
-                    //newline
-                    if(!wasNewLine)
-                    {
-                        scope.insert(i, 1, NEWLINE);
+                    const ssize_t bytesRead = read(output.fileDescriptor, buffer.data(), buffer.size());
 
-                        namespaceScope += 1;
-                        //namespaceScope.end++;
-                        i++;
+                    if(bytesRead == 0)
+                    {
+                        isStopped = !dispatcher.Finish();
+                        break;
                     }
-                    /*if(!wasNewLine && i > 0)
+                    if(bytesRead < 0)
                     {
-                        for(index j = i - 1; j >= 0; j--)
-                            if(scope[j] == NEWLINE)
-                            {
-                                wasNewLine = true;
-                                break;
-                            }
-                            else if(scope[j] != TAB && scope[j] != WHITESPACE)
-                                break;
+                        if(errno == EINTR)
+                            continue;
+
+                        readError = errno;
+                        isStopped = true;
+                        break;
+                    }
+
+                    isStopped = !dispatcher.Dispatch({ buffer.data(), static_cast<size_t>(bytesRead) }) || stopToken.stop_requested();
+                }
+
+                if(isStopped)
+                    kill(killTarget, SIGKILL);
+            }
+
+            const auto exitStatus = WaitForProcess(childProcess.processID);
+
+            if(readError != 0)
+                return std::unexpected{ ReceiveCommandErrorMessage(readError) };
+
+            return exitStatus;
+        }
+    }
+
+    std::expected<ResourcesManager::CommandResult, std::string> ResourcesManager::ExecuteCommand(const std::string_view& command, uint32_t outputs, bool useShell)
+    {
+        if(useShell)
+            return ExecuteCommand(std::vector<std::string>{ "/bin/sh", "-c", std::string{ command } }, outputs);
+
+        const auto arguments = SplitCommand(command);
+
+        if(!arguments)
+            return std::unexpected{ arguments.error() };
+
+        return ExecuteCommand(*arguments, outputs);
+    }
+    std::expected<ResourcesManager::CommandResult, std::string> ResourcesManager::ExecuteCommand(const std::vector<std::string>& arguments, uint32_t outputs)
+    {
+        if(arguments.empty())
+            return std::unexpected{ "Failed to execute command: the command is empty." };
 
-                        if(!wasNewLine)
-                        {
-                            scope.insert(i, 1, NEWLINE);
+        ChildProcess childProcess{};
+        if(const int error = SpawnProcess(arguments, false, childProcess); error != 0)
+            return std::unexpected{ ReceiveCommandErrorMessage(error) };
 
-                            namespaceScope.end++;
-                            i++;
-                        }
-                    }*/
+        CommandResult result{};
 
-                    //tabs
-                    for(size_t scopeDistancesCount = 0; scopeDistancesCount < scopesOpened; scopeDistancesCount++)
-                        scope.insert(i, SCOPE_DISTANCE);
+        if(outputs != std::numeric_limits<uint32_t>::max())
+            result.outputs.reserve(outputs);
 
-                    i += scopesOpened * SCOPE_DISTANCE.size();
-                    //namespaceScope.end += scopesOpened * SCOPE_DISTANCE.size();
-                    namespaceScope += scopesOpened * SCOPE_DISTANCE.size();
+        const OutputCallback collectLine = [&result, outputs](std::string_view line)
+            {
+                if(result.outputs.size() == outputs)
+                    return false;
 
-                    scopesOpened++;
-                }
-                else if(currentChar == SCOPE_CLOSE)
-                {
-                    //newline
-                    if(!wasNewLine && i > 0 && scope[i - 1] != NEWLINE)
-                    {
-                        scope.insert(i, 1, NEWLINE);
+                result.outputs.emplace_back(line);
 
-                        namespaceScope.end++;
-                        i++;
-                    }
+                return result.outputs.size() < outputs;
+            };
 
-                    const auto _scopesOpened = (scopesOpened > 0 ? scopesOpened - 1 : 0);//cuz it is SCOPE_CLOSE
+        OutputDispatcher dispatcher{ collectLine, OutputMode::Lines };
 
-                    //tabs
-                    for(size_t scopeDistancesCount = 0; scopeDistancesCount < _scopesOpened; scopeDistancesCount++)
-                        scope.insert(i, SCOPE_DISTANCE);
+        const auto exitStatus = RunProcess(childProcess, dispatcher, {});
 
-                    i += _scopesOpened * SCOPE_DISTANCE.size();
-                    namespaceScope.end += _scopesOpened * SCOPE_DISTANCE.size();
+        if(!exitStatus)
+            return std::unexpected{ exitStatus.error() };
 
-                    scopesOpened--;
-                }
-                else if(currentChar == NEWLINE)
-                {
-                    wasNewLine = true;
-                }
-                else if(currentChar == WHITESPACE)
-                {
-                    size_t whitespacesCount = 0;
-                    for(index j = i; j < scope.size(); j++)
-                    {
-                        const char currentVariableChar = scope[j];
+        result.exitStatus = *exitStatus;
 
-                        if(currentVariableChar == WHITESPACE)
-                            whitespacesCount++;
-                        else
-                            break;
-                    }
+        return result;
+    }
 
-                    scope.erase(i, whitespacesCount);
+    std::expected<int, std::string> ResourcesManager::ExecuteCommandStreaming(const std::string_view& command, const OutputCallback& callback, OutputMode outputMode, bool useShell, std::stop_token stopToken)
+    {
+        if(useShell)
+            return ExecuteCommandStreaming(std::vector<std::string>{ "/bin/sh", "-c", std::string{ command } }, callback, outputMode, std::move(stopToken));
 
-                    namespaceScope.end -= whitespacesCount;
+        const auto arguments = SplitCommand(command);
 
-                    increment = false;
-                }
-                else if(currentChar == TAB)
-                {
-                    size_t tabsCount = 0;
-                    for(index j = i; j < scope.size(); j++)
+        if(!arguments)
+            return std::unexpected{ arguments.error() };
+
+        return ExecuteCommandStreaming(*arguments, callback, outputMode, std::move(stopToken));
+    }
+    std::expected<int, std::string> ResourcesManager::ExecuteCommandStreaming(const std::vector<std::string>& arguments, const OutputCallback& callback, OutputMode outputMode, std::stop_token stopToken)
+    {
+        if(arguments.empty())
+            return std::unexpected{ "Failed to execute command: the command is empty." };
+
+        //so the processes started by a shell are killed too
+        ChildProcess childProcess{};
+        if(const int error = SpawnProcess(arguments, true, childProcess); error != 0)
+            return std::unexpected{ ReceiveCommandErrorMessage(error) };
+
+        OutputDispatcher dispatcher{ callback, outputMode };
+
+        return RunProcess(childProcess, dispatcher, stopToken);
+    }
+
+    namespace
+    {
+        //pidfd of the process, readable when it exits. -1 if the kernel doesn't support it
+        int OpenExitFileDescriptor(pid_t processID) noexcept
+        {
+#if defined(__linux__) && defined(SYS_pidfd_open)
+            return static_cast<int>(syscall(SYS_pidfd_open, processID, 0));
+#else
+            return -1;
+#endif
+        }
+
+        struct RunningProcess
+        {
+            RunningProcess(const ChildProcess& childProcess, uint32_t outputs, ResourcesManager::CommandExecutor::CompletionCallback&& callback)
+                : processID(childProcess.processID), outputFileDescriptor(childProcess.outputFileDescriptor), exitFileDescriptor(OpenExitFileDescriptor(childProcess.processID)),
+                outputs(outputs), callback(std::move(callback)),
+                collectLine([this](std::string_view line)
                     {
-                        const char currentVariableChar = scope[j];
+                        if(result.outputs.size() == this->outputs)
+                            return false;
 
-                        if(currentVariableChar == TAB)
-                            tabsCount++;
-                        else
-                            break;
-                    }
+                        result.outputs.emplace_back(line);
 
-                    scope.erase(i, tabsCount);
+                        return result.outputs.size() < this->outputs;
+                    }),
+                dispatcher{ collectLine, ResourcesManager::OutputMode::Lines }
+            {
+                fcntl(outputFileDescriptor, F_SETFL, fcntl(outputFileDescriptor, F_GETFL) | O_NONBLOCK);
+            }
+            ~RunningProcess()
+            {
+                CloseOutput();
 
-                    namespaceScope.end -= tabsCount;
-                }
+                if(exitFileDescriptor >= 0)
+                    close(exitFileDescriptor);
             }
-            else if(parsingDataType == ParsingDataType::Variable)
+
+            RunningProcess(const RunningProcess& other) = delete;
+            RunningProcess& operator=(const RunningProcess& other) = delete;
+
+            void CloseOutput() noexcept
             {
-                //newline
-                if(!wasNewLine && i > 0)
-                {
-                    scope.insert(i, 1, NEWLINE);
+                if(outputFileDescriptor >= 0)
+                    close(outputFileDescriptor);
 
-                    namespaceScope.end++;
-                    i++;
-                }
+                outputFileDescriptor = -1;
+            }
+            //reads what is available now, closes the output at EOF. Returns an errno value, 0 on success
+            int ReadOutput(std::string& buffer)
+            {
+                const ssize_t bytesRead = read(outputFileDescriptor, buffer.data(), buffer.size());
 
-                //tabs
-                for(size_t scopeDistancesCount = 0; scopeDistancesCount < scopesOpened; scopeDistancesCount++)
-                    scope.insert(i, SCOPE_DISTANCE);
+                if(bytesRead < 0)
+                    return errno == EAGAIN || errno == EINTR ? 0 : errno;
 
-                i += scopesOpened * SCOPE_DISTANCE.size();
-                namespaceScope.end += scopesOpened * SCOPE_DISTANCE.size();
+                const bool isStopped = bytesRead == 0 ? !dispatcher.Finish() : !dispatcher.Dispatch({ buffer.data(), static_cast<size_t>(bytesRead) });
 
-                VariableIndicesInfo variableIndices = ReceiveVariableInfo(scope, i);
+                if(isStopped)
+                    kill(processID, SIGKILL);
+                if(bytesRead == 0 || isStopped)
+                    CloseOutput();
 
-                /*std::string dbgFinal1;
-                {
-                    auto dbg1 = variableIndices.type.GetSubstring<std::string_view>(scope);
-                    auto dbg2 = variableIndices.name.GetSubstring<std::string_view>(scope);
-                    auto dbg3 = scope[variableIndices.equals];
-                    auto dbg4 = variableIndices.value.GetSubstring<std::string_view>(scope);
-                    auto dbg5 = scope[variableIndices.semicolon];
+                return 0;
+            }
 
-                    dbgFinal1 = GuelderConsoleLog::Logger::Format(dbg1, dbg2, dbg3, dbg4, dbg5);
-                }*/
+            pid_t processID;
+            //-1 after EOF, the process may still be running
+            int outputFileDescriptor;
+            //polled after EOF instead of checking the exit every EXIT_CHECK_INTERVAL_MS
+            int exitFileDescriptor;
+            uint32_t outputs;
+            ResourcesManager::CommandExecutor::CompletionCallback callback;
+            ResourcesManager::CommandResult result{};
+            ResourcesManager::OutputCallback collectLine;
+            OutputDispatcher dispatcher;
+        };
+    }
 
+    ResourcesManager::CommandExecutor::CommandExecutor(uint32_t maxProcesses)
+        : m_MaxProcesses(maxProcesses != 0 ? maxProcesses : std::max(std::thread::hardware_concurrency(), 1u)), m_UnfinishedTasksCount(0), m_Error(0)
+    {
+        if(const int error = CreateCloseOnExecPipe(m_WakeUpFileDescriptors); error != 0)
+            throw std::system_error{ error, std::generic_category(), "Failed to create command executor" };
 
-                //checking for gaps
-                {
-                    bool incrementJ = true;
+        //a full pipe already wakes up the thread
+        fcntl(m_WakeUpFileDescriptors[0], F_SETFL, O_NONBLOCK);
+        fcntl(m_WakeUpFileDescriptors[1], F_SETFL, O_NONBLOCK);
 
-                    for(index j = variableIndices.type.end + 1, extraCharsCount = 0; j <= variableIndices.semicolon;)
-                    {
-                        const char currentVariableChar = scope[j];
+        m_Thread = std::jthread{ [this](std::stop_token stopToken) { Run(std::move(stopToken)); } };
+    }
+    ResourcesManager::CommandExecutor::~CommandExecutor()
+    {
+        m_Thread.request_stop();
+        WakeUp();
+        m_Thread.join();
 
-                        if(currentVariableChar == WHITESPACE || currentVariableChar == TAB)
-                            extraCharsCount++;
-                        else
-                        {
-                            if(extraCharsCount > ACCEPTABLE_WHITESPACES_COUNT)
-                            {
-                                const size_t extraCharsCountToDelete = extraCharsCount - 1;
+        close(m_WakeUpFileDescriptors[0]);
+        close(m_WakeUpFileDescriptors[1]);
+    }
 
-                                scope.erase(j - extraCharsCount, extraCharsCountToDelete);
+    std::future<std::expected<ResourcesManager::CommandResult, std::string>> ResourcesManager::CommandExecutor::Submit(const std::string_view& command, uint32_t outputs, bool useShell)
+    {
+        if(useShell)
+            return Submit(std::vector<std::string>{ "/bin/sh", "-c", std::string{ command } }, outputs);
 
-                                namespaceScope.end -= extraCharsCountToDelete;
+        auto arguments = SplitCommand(command);
 
-                                if(j == variableIndices.name.begin)
-                                {
-                                    variableIndices.name -= extraCharsCountToDelete;
-                                    variableIndices.equals -= extraCharsCountToDelete;
-                                    variableIndices.value -= extraCharsCountToDelete;
-                                    variableIndices.semicolon -= extraCharsCountToDelete;
+        if(!arguments)
+        {
+            std::promise<std::expected<CommandResult, std::string>> promise;
+            promise.set_value(std::unexpected{ std::move(arguments.error()) });
 
-                                    j = variableIndices.name.end + 1;
-                                }
-                                else if(j == variableIndices.equals)
-                                {
-                                    variableIndices.equals -= extraCharsCountToDelete;
-                                    variableIndices.value -= extraCharsCountToDelete;
-                                    variableIndices.semicolon -= extraCharsCountToDelete;
+            return promise.get_future();
+        }
 
-                                    j = variableIndices.equals + 1;
-                                }
-                                else if(j == variableIndices.value.begin)
-                                {
-                                    variableIndices.value -= extraCharsCountToDelete;
-                                    variableIndices.semicolon -= extraCharsCountToDelete;
+        return Submit(std::move(*arguments), outputs);
+    }
+    std::future<std::expected<ResourcesManager::CommandResult, std::string>> ResourcesManager::CommandExecutor::Submit(std::vector<std::string> arguments, uint32_t outputs)
+    {
+        //std::function must be copyable
+        auto promise = std::make_shared<std::promise<std::expected<CommandResult, std::string>>>();
+        auto future = promise->get_future();
 
-                                    j = variableIndices.value.end;
-                                }
-                                else if(j == variableIndices.semicolon)
-                                {
-                                    variableIndices.semicolon -= extraCharsCountToDelete;
+        Submit(std::move(arguments), [promise](std::expected<CommandResult, std::string>&& result) { promise->set_value(std::move(result)); }, outputs);
 
-                                    break;
-                                }
+        return future;
+    }
+    void ResourcesManager::CommandExecutor::Submit(std::vector<std::string> arguments, CompletionCallback callback, uint32_t outputs)
+    {
+        int error;
 
-                                incrementJ = false;
-                            }
+        {
+            std::lock_guard lock{ m_Mutex };
 
-                            extraCharsCount = 0;
-                        }
+            error = m_Error;
 
-                        if(!incrementJ)
-                            incrementJ = true;
-                        else
-                            j++;
-                    }
-                }
+            if(error == 0)
+            {
+                m_Tasks.push_back(Task{ std::move(arguments), outputs, std::move(callback) });
+                m_UnfinishedTasksCount++;
+            }
+        }
 
-                /*std::string dbgFinal2;
-                {
-                    auto dbg1 = variableIndices.type.GetSubstring<std::string_view>(scope);
-                    auto dbg2 = variableIndices.name.GetSubstring<std::string_view>(scope);
-                    auto dbg3 = scope[variableIndices.equals];
-                    auto dbg4 = variableIndices.value.GetSubstring<std::string_view>(scope);
-                    auto dbg5 = scope[variableIndices.semicolon];
+        //the thread of the executor has exited
+        if(error != 0)
+            callback(std::unexpected{ ReceiveCommandErrorMessage(error) });
+        else
+            WakeUp();
+    }
 
-                    dbgFinal2 = GuelderConsoleLog::Logger::Format(dbg1, dbg2, dbg3, dbg4, dbg5);
-                }
+    void ResourcesManager::CommandExecutor::Wait()
+    {
+        std::unique_lock lock{ m_Mutex };
+        m_IdleCondition.wait(lock, [this] { return m_UnfinishedTasksCount == 0; });
+    }
 
-                bool dbgBool = dbgFinal1 == dbgFinal2;*/
+    uint32_t ResourcesManager::CommandExecutor::GetMaxProcesses() const noexcept
+    {
+        return m_MaxProcesses;
+    }
 
-                i = variableIndices.semicolon + 1;
+    void ResourcesManager::CommandExecutor::Run(std::stop_token stopToken)
+    {
+        //how often the processes which closed their output but haven't exited yet are checked, if there is no pidfd to poll
+        constexpr int EXIT_CHECK_INTERVAL_MS = 5;
 
-                increment = false;
+        std::vector<std::unique_ptr<RunningProcess>> processes;
+        std::vector<pollfd> pollFileDescriptors;
+        std::string buffer(COMMAND_OUTPUT_READ_SIZE, '\0');
 
-                wasNewLine = false;
-            }
-            else if(parsingDataType == ParsingDataType::Namespace)
+        //taken from the queue, the ones from startedTasksCount are not started yet
+        std::vector<Task> tasksToStart;
+        size_t startedTasksCount = 0;
+
+        int executorError = 0;
+
+        try
+        {
+            while(true)
             {
-                //newline
-                if(!wasNewLine && i > 0)
+                tasksToStart = ReceiveTasksToStart(processes.size());
+
+                for(startedTasksCount = 0; startedTasksCount < tasksToStart.size();)
                 {
-                    scope.insert(i, 1, NEWLINE);
+                    Task& task = tasksToStart[startedTasksCount++];
+                    ChildProcess childProcess{};
 
-                    namespaceScope.end++;
-                    i++;
+                    if(task.arguments.empty())
+                        Complete(task.callback, std::unexpected{ "Failed to execute command: the command is empty." });
+                    else if(const int error = SpawnProcess(task.arguments, false, childProcess); error != 0)
+                        Complete(task.callback, std::unexpected{ ReceiveCommandErrorMessage(error) });
+                    else
+                        processes.push_back(std::make_unique<RunningProcess>(childProcess, task.outputs, std::move(task.callback)));
                 }
 
-                //tabs
-                for(size_t scopeDistancesCount = 0; scopeDistancesCount < scopesOpened; scopeDistancesCount++)
-                    scope.insert(i, SCOPE_DISTANCE);
+                if(processes.empty() && stopToken.stop_requested())
+                {
+                    std::lock_guard lock{ m_Mutex };
 
-                i += scopesOpened * SCOPE_DISTANCE.size();
-                namespaceScope.end += scopesOpened * SCOPE_DISTANCE.size();
+                    if(m_Tasks.empty())
+                        break;
+                }
 
-                NamespaceIndicesInfo namespaceIndices = ReceiveNamespaceInfo(scope, i);
+                pollFileDescriptors.clear();
+                pollFileDescriptors.push_back({ m_WakeUpFileDescriptors[0], POLLIN, 0 });
 
-                //checking for gaps
-                {
-                    bool incrementJ = true;
-                    bool wasNewLineBetweenNamespaceTokens = false;
+                bool isWaitingForExit = false;
 
-                    for(index j = namespaceIndices.keyword.end + 1, extraCharsCount = 0; j <= namespaceIndices.scope.begin;)
+                for(const auto& process : processes)
+                {
+                    //fd -1 is ignored by poll, so the indices match
+                    if(process->outputFileDescriptor >= 0)
+                        pollFileDescriptors.push_back({ process->outputFileDescriptor, POLLIN, 0 });
+                    else
                     {
-                        const char currentVariableChar = scope[j];
+                        pollFileDescriptors.push_back({ process->exitFileDescriptor, POLLIN, 0 });
 
-                        if(currentVariableChar == WHITESPACE || currentVariableChar == TAB)
-                            extraCharsCount++;
-                        else
-                        {
-                            if(j > namespaceIndices.name.end && j < namespaceIndices.scope.begin && currentVariableChar == NEWLINE)
-                                wasNewLineBetweenNamespaceTokens = true;
+                        if(process->exitFileDescriptor < 0)
+                            isWaitingForExit = true;
+                    }
+                }
 
-                            if(extraCharsCount > ACCEPTABLE_WHITESPACES_COUNT)
-                            {
-                                const size_t extraCharsCountToDelete = extraCharsCount;
+                if(poll(pollFileDescriptors.data(), pollFileDescriptors.size(), isWaitingForExit ? EXIT_CHECK_INTERVAL_MS : -1) < 0 && errno != EINTR)
+                {
+                    executorError = errno;
+                    break;
+                }
 
-                                scope.erase(j - extraCharsCount, extraCharsCountToDelete);
+                if(pollFileDescriptors[0].revents != 0)
+                {
+                    char wakeUpBuffer[64];
+                    while(read(m_WakeUpFileDescriptors[0], wakeUpBuffer, sizeof(wakeUpBuffer)) > 0);
+                }
 
-                                namespaceScope.end -= extraCharsCountToDelete;
+                for(size_t i = 0; i < processes.size();)
+                {
+                    RunningProcess& process = *processes[i];
+                    int error = 0;
 
-                                if(j == namespaceIndices.name.begin)
-                                {
-                                    namespaceIndices.name -= extraCharsCountToDelete;
-                                    namespaceIndices.scope -= extraCharsCountToDelete;
+                    if(process.outputFileDescriptor >= 0 && pollFileDescriptors[i + 1].revents != 0)
+                        error = process.ReadOutput(buffer);
 
-                                    j = namespaceIndices.name.end + 1;
-                                }
-                                else if(j == namespaceIndices.scope.begin)
-                                {
-                                    namespaceIndices.scope -= extraCharsCountToDelete;
+                    if(error != 0)
+                    {
+                        kill(process.processID, SIGKILL);
+                        process.CloseOutput();
+                    }
 
-                                    break;
-                                }
+                    int status = 0;
 
-                                incrementJ = false;
-                            }
+                    if(process.outputFileDescriptor >= 0 || waitpid(process.processID, &status, WNOHANG) == 0)
+                    {
+                        i++;
+                        continue;
+                    }
 
-                            extraCharsCount = 0;
-                        }
+                    //the order of pollFileDescriptors doesn't matter anymore
+                    auto finishedProcess = std::move(processes[i]);
+                    processes[i] = std::move(processes.back());
+                    processes.pop_back();
+                    pollFileDescriptors[i + 1] = pollFileDescriptors[processes.size() + 1];
 
-                        if(!incrementJ)
-                            incrementJ = true;
-                        else
-                            j++;
+                    if(error != 0)
+                        Complete(finishedProcess->callback, std::unexpected{ ReceiveCommandErrorMessage(error) });
+                    else
+                    {
+                        finishedProcess->result.exitStatus = WIFSIGNALED(status) ? 128 + WTERMSIG(status) : WEXITSTATUS(status);
+                        Complete(finishedProcess->callback, std::move(finishedProcess->result));
                     }
-
-                    wasNewLine = wasNewLineBetweenNamespaceTokens;
                 }
+            }
+        }
+        catch(...)
+        {
+            //a callback has thrown
+            executorError = ECANCELED;
+        }
 
-                const index beforeScopeBegin = namespaceIndices.scope.begin;
-                const index beforeScopeEnd = namespaceIndices.scope.end;
+        if(executorError == 0)
+            return;
 
-                i = FormatScope(scope, namespaceIndices.scope, scopesOpened, wasNewLine);
+        //everything that is not completed yet fails, the callbacks cannot stop it anymore
+        const auto CompleteWithError = [this, executorError](const CompletionCallback& callback)
+            {
+                try
+                {
+                    Complete(callback, std::unexpected{ ReceiveCommandErrorMessage(executorError) });
+                }
+                catch(...) {}
+            };
 
-                const index toAddAfterFormattingScopeBegin = namespaceIndices.scope.begin - beforeScopeBegin;
-                const index toAddAfterFormattingScopeEnd = namespaceIndices.scope.end - beforeScopeEnd;
+        for(const auto& process : processes)
+        {
+            kill(process->processID, SIGKILL);
+            process->CloseOutput();
+            waitpid(process->processID, nullptr, 0);
 
-                //namespaceScope.end += toAddAfterFormattingScopeBegin;
-                namespaceScope.begin += toAddAfterFormattingScopeBegin;
-                namespaceScope.end += toAddAfterFormattingScopeEnd;
-                //namespaceScope.begin = namespaceIndices.scope.begin;
-                //namespaceScope.end = namespaceIndices.scope.end;
+            CompleteWithError(process->callback);
+        }
 
-                increment = false;
+        for(; startedTasksCount < tasksToStart.size(); startedTasksCount++)
+            CompleteWithError(tasksToStart[startedTasksCount].callback);
 
-                wasNewLine = false;
-            }
+        std::deque<Task> queuedTasks;
 
-            if(!increment)
-                increment = true;
-            else
-                i++;
+        {
+            std::lock_guard lock{ m_Mutex };
+
+            m_Error = executorError;
+            queuedTasks = std::move(m_Tasks);
+            m_Tasks.clear();
         }
 
-        return namespaceScope.end + (namespaceScope.end < scope.size() - 1);
+        for(const auto& task : queuedTasks)
+            CompleteWithError(task.callback);
     }
+    std::vector<ResourcesManager::CommandExecutor::Task> ResourcesManager::CommandExecutor::ReceiveTasksToStart(size_t runningProcessesCount)
+    {
+        std::vector<Task> tasks;
 
-    ConfigFile::Parser::StringRange ConfigFile::Parser::CorrectStringRange(index scopeEnd, StringRange stringRange)
+        std::lock_guard lock{ m_Mutex };
+
+        while(runningProcessesCount + tasks.size() < m_MaxProcesses && !m_Tasks.empty())
+        {
+            tasks.push_back(std::move(m_Tasks.front()));
+            m_Tasks.pop_front();
+        }
+
+        return tasks;
+    }
+    void ResourcesManager::CommandExecutor::Complete(const CompletionCallback& callback, std::expected<CommandResult, std::string>&& result)
     {
-        if(stringRange.begin == std::string::npos)
-            stringRange.begin = 0;
-        if(stringRange.end == std::string::npos)
-            stringRange.end = scopeEnd;
+        std::exception_ptr exception;
+
+        try
+        {
+            callback(std::move(result));
+        }
+        catch(...)
+        {
+            exception = std::current_exception();
+        }
+
+        {
+            std::lock_guard lock{ m_Mutex };
 
-        return stringRange;
-    }
+            if(--m_UnfinishedTasksCount == 0)
+                m_IdleCondition.notify_all();
+        }
 
-    ConfigFile::Parser::StringRange ConfigFile::Parser::CorrectStringRange(const std::string_view& scope, const StringRange& stringRange)
+        if(exception)
+            std::rethrow_exception(exception);
+    }
+    void ResourcesManager::CommandExecutor::WakeUp() const noexcept
     {
-        return CorrectStringRange((scope.empty() ? 0 : scope.size() - 1), stringRange);
+        const char wakeUp = 0;
+        //EAGAIN means the pipe is full, so the thread will wake up anyway
+        [[maybe_unused]] const auto result = write(m_WakeUpFileDescriptors[1], &wakeUp, 1);
     }
-
-    std::string ConfigFile::Parser::AddSpecialChars(std::string variableValue)
+#else
+    std::expected<int, std::string> ResourcesManager::ExecuteCommandStreaming(const std::string_view& command, const OutputCallback& callback, OutputMode outputMode, bool useShell, std::stop_token stopToken)
     {
-        if(!variableValue.empty())
-            for(index i = variableValue.size() - 1; i >= 0; i--)
-            {
-                const char currentChar = variableValue[i];
-
-                for(auto specialChar : SPECIAL_CHARS)
-                    if(currentChar == specialChar)
-                        variableValue.insert(i, 1, SPECIAL_CHAR_SIGN);
-            }
+        std::string commandLine = useShell ? std::format("cmd.exe /C {}", command) : std::string{ command };
 
-        return variableValue;
-    }
+        ProcessInfo processInfo;
+        Handle readPipe;
 
-    size_t ConfigFile::Parser::DetermineReserveSize(const Variable& variable)
-    {
-        size_t result = 0;
+        {
+            Handle writePipe;
 
-        result += DataTypeToString(variable.GetType()).size();
+            SECURITY_ATTRIBUTES securityAttributes{ sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE };
+            if(!CreatePipe(&readPipe.handle, &writePipe.handle, &securityAttributes, 0))
+                return std::unexpected{ std::format("Failed to execute command: error {}.", GetLastError()) };
 
-        result += variable.GetName().size();
+            SetHandleInformation(readPipe, HANDLE_FLAG_INHERIT, 0);
 
-        result += 2;//VARIABLE_VALUE_SCOPE or SCOPE_OPEN, SCOPE_CLOSE
+            STARTUPINFOA startupInfo{};
+            startupInfo.cb = sizeof(startupInfo);
+            startupInfo.dwFlags = STARTF_USESTDHANDLES;
+            startupInfo.hStdOutput = writePipe;
+            startupInfo.hStdError = writePipe;
+            startupInfo.hStdInput = nullptr;
 
-        result += variable.GetRawValue().size();
+            if(!CreateProcessA(nullptr, commandLine.data(), nullptr, nullptr, TRUE, CREATE_NO_WINDOW, nullptr, nullptr, &startupInfo, &processInfo.processInfo))
+                return std::unexpected{ std::format("Failed to execute command: error {}.", GetLastError()) };
+        }
 
-        result += 3;//WHITESPACEs
+        const HANDLE process = processInfo.processInfo.hProcess;
 
-        result += 1;//SEMICOLON
+        {
+            OutputDispatcher dispatcher{ callback, outputMode };
 
-        return result;
-    }
+            //the handle is closed only after the callback is destroyed
+            const std::stop_callback stopCallback{ stopToken, [process] { ::TerminateProcess(process, 1); } };
 
-    ConfigFile::Parser::ParsingDataType ConfigFile::Parser::DetermineParsingDataType(const std::string_view& scope, index currentCharIndex, bool& wasCommentScopeClosed, bool& wasValueScopeClosed)
-    {
-        char currentChar = scope[currentCharIndex];
+            std::string buffer(COMMAND_OUTPUT_READ_SIZE, '\0');
+            bool isStopped = false;
+            DWORD bytesRead;
 
-        if(currentChar == NEWLINE)
-            wasCommentScopeClosed = true;
-        else if(!wasCommentScopeClosed || IsFullSubstringSame(scope, currentCharIndex, COMMENT_SCOPE_LINE))
-        {
-            wasCommentScopeClosed = false;
-            return ParsingDataType::Comment;
-        }
-        else
-        {
-            if(currentChar == VARIABLE_VALUE_SCOPE)
+            while(!isStopped)
             {
-                if(!wasValueScopeClosed && currentCharIndex > 0 && scope[currentCharIndex - 1] != SPECIAL_CHAR_SIGN)
-                    wasValueScopeClosed = true;
-                else
+                //fails with ERROR_BROKEN_PIPE when the process exits
+                if(!ReadFile(readPipe, buffer.data(), static_cast<DWORD>(buffer.size()), &bytesRead, nullptr) || bytesRead == 0)
                 {
-                    wasValueScopeClosed = false;
-                    return ParsingDataType::VariableValue;
+                    isStopped = !dispatcher.Finish();
+                    break;
                 }
+
+                isStopped = !dispatcher.Dispatch({ buffer.data(), bytesRead }) || stopToken.stop_requested();
             }
-            else if(wasValueScopeClosed)
-            {
-                if(IsFullSubstringSame(scope, currentCharIndex, NAMESPACE_KEYWORD))
-                    return ParsingDataType::Namespace;
-                else if(Variable::IsValidVariableChar(currentChar))
-                    return ParsingDataType::Variable;
-            }
+
+            if(isStopped)
+                ::TerminateProcess(process, 1);
         }
 
-        return ParsingDataType::Invalid;
+        WaitForSingleObject(process, INFINITE);
+
+        DWORD exitCode = 0;
+        if(!GetExitCodeProcess(process, &exitCode))
+            return std::unexpected{ std::format("Failed to execute command: error {}.", GetLastError()) };
+
+        return static_cast<int>(exitCode);
     }
+#endif
 
-    bool ConfigFile::Parser::IsArray(const std::string_view& variableValue)
+    std::filesystem::path ResourcesManager::GetFullPathToRelativeFile(const std::filesystem::path& relativePath) const
     {
-        if(variableValue.empty())
-            return false;
+        return m_Path / relativePath;
+    }
 
-        bool isArray = true;
+    const std::filesystem::path& ResourcesManager::GetPath() const
+    {
+        return m_Path;
+    }
+}
+//ConfigFile::Watcher
+namespace GuelderResourcesManager
+{
+    namespace
+    {
+        //what the polling compares. The write time alone is not enough, its precision may be coarser than the time between two saves
+        struct FileVersion
+        {
+            //only compared, so the epoch doesn't matter
+            std::chrono::nanoseconds writeTime;
+            uintmax_t size;
+            //SaveMode::Atomic always creates a new file
+            uintmax_t fileID;
 
-        if(variableValue[0] != SCOPE_OPEN)
-            isArray = false;
-        if(isArray && variableValue[variableValue.size() - 1] != SCOPE_CLOSE)
-            isArray = false;
+            bool operator==(const FileVersion&) const = default;
+        };
 
-        if(isArray)
+        //all zeros if the file doesn't exist
+        FileVersion ReceiveFileVersion(const std::filesystem::path& filePath) noexcept
         {
-            bool valueScopeClosed = true;
-            for(index i = 1; i < variableValue.size(); i++)
-            {
-                const char currentChar = variableValue[i];
+#ifndef WIN32
+            struct stat fileStat{};
+            if(stat(filePath.c_str(), &fileStat) != 0)
+                return {};
 
-                if(currentChar == VARIABLE_VALUE_SCOPE && variableValue[i - 1] != SPECIAL_CHAR_SIGN)
-                    valueScopeClosed = !valueScopeClosed;
-            }
+            const std::chrono::nanoseconds writeTime = std::chrono::seconds{ fileStat.st_mtim.tv_sec } + std::chrono::nanoseconds{ fileStat.st_mtim.tv_nsec };
 
-            isArray = valueScopeClosed;
-        }
+            return { writeTime, static_cast<uintmax_t>(fileStat.st_size), static_cast<uintmax_t>(fileStat.st_ino) };
+#else
+            std::error_code errorCode;
 
-        return isArray;
-    }
-}
-//ConfigFile::Parser's indices stuff
-namespace GuelderResourcesManager
-{
+            const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(filePath, errorCode);
+            if(errorCode)
+                return {};
 
-    ConfigFile::Parser::StringRange::StringRange(index begin, index end)
-        : begin(begin), end(end)
-    {
-        if(begin > end)
-            throw std::invalid_argument{ "begin cannot be bigger than end" };
-    }
+            const uintmax_t size = std::filesystem::file_size(filePath, errorCode);
 
-    bool ConfigFile::Parser::StringRange::IsValid() const noexcept
-    {
-        return begin != std::string::npos && end != std::string::npos;
+            return { std::chrono::duration_cast<std::chrono::nanoseconds>(writeTime.time_since_epoch()), errorCode ? 0 : size, 0 };
+#endif
+        }
     }
 
-    ConfigFile::Parser::StringRange& ConfigFile::Parser::StringRange::operator+=(index offset)
+    ConfigFile::Watcher::Watcher(std::filesystem::path configFilePath, StorageMode storageMode, std::chrono::milliseconds pollingInterval)
+        : m_Path(std::move(configFilePath)), m_StorageMode(storageMode), m_PollingInterval(pollingInterval), m_LastSubscriptionID(0)
     {
-        begin += offset;
-        end += offset;
+        //shared, so the thread never touches a destroyed promise
+        const std::shared_ptr<std::promise<void>> watchStarted = std::make_shared<std::promise<void>>();
+        std::future<void> watchStartedFuture = watchStarted->get_future();
 
-        return *this;
-    }
+        m_Thread = std::jthread{ [this, watchStarted](std::stop_token stopToken) { Run(std::move(stopToken), watchStarted); } };
 
-    ConfigFile::Parser::StringRange& ConfigFile::Parser::StringRange::operator-=(index offset)
-    {
-        begin -= offset;
-        end -= offset;
+        watchStartedFuture.wait();
 
-        return *this;
+        //if it throws, m_Thread is stopped by its destructor
+        Reload();
     }
-
-    ConfigFile::Parser::NamespaceIndicesInfo& ConfigFile::Parser::NamespaceIndicesInfo::operator+=(index offset)
+    ConfigFile::Watcher::~Watcher()
     {
-        keyword += offset;
-        name += offset;
-        scope += offset;
+        m_Thread.request_stop();
 
-        return *this;
+        if(m_Thread.joinable())
+            m_Thread.join();
     }
 
-    ConfigFile::Parser::StringRange operator+(const ConfigFile::Parser::StringRange& lhs, const ConfigFile::Parser::StringRange& rhs)
+    std::shared_ptr<const ConfigFile::Snapshot> ConfigFile::Watcher::GetSnapshot() const noexcept
     {
-        return { lhs.begin + rhs.begin, lhs.end + rhs.end };
+        return m_SnapshotPublisher.GetSnapshot();
     }
-    ConfigFile::Parser::StringRange operator+(const ConfigFile::Parser::StringRange& lhs, ConfigFile::Parser::index rhs)
+    uint64_t ConfigFile::Watcher::GetVersion() const noexcept
     {
-        return { lhs.begin + rhs, lhs.end + rhs };
+        return m_SnapshotPublisher.GetVersion();
     }
-
-    ConfigFile::Parser::NamespaceIndicesInfo operator+(const ConfigFile::Parser::NamespaceIndicesInfo& lhs, const ConfigFile::Parser::NamespaceIndicesInfo& rhs)
+    const ConfigFile::SnapshotPublisher& ConfigFile::Watcher::GetSnapshotPublisher() const noexcept
     {
-        return
-        {
-            lhs.keyword + rhs.keyword,
-            lhs.name + rhs.name,
-            lhs.scope + rhs.scope,
-        };
+        return m_SnapshotPublisher;
     }
-    ConfigFile::Parser::NamespaceIndicesInfo operator+(const ConfigFile::Parser::NamespaceIndicesInfo& lhs, ConfigFile::Parser::index rhs)
+    const std::filesystem::path& ConfigFile::Watcher::GetPath() const noexcept
     {
-        return
-        {
-            lhs.keyword + rhs,
-            lhs.name + rhs,
-            lhs.scope + rhs,
-        };
+        return m_Path;
     }
 
-    ConfigFile::Parser::VariableIndicesInfo operator+(const ConfigFile::Parser::VariableIndicesInfo& lhs, const ConfigFile::Parser::VariableIndicesInfo& rhs)
+    size_t ConfigFile::Watcher::Subscribe(std::string variablePath, Callback callback)
     {
-        return
-        {
-            lhs.type + rhs.type,
-            lhs.equals + rhs.equals,
-            lhs.name + rhs.name,
-            lhs.value + rhs.value,
-            lhs.semicolon + rhs.semicolon
-        };
+        const std::lock_guard lock{ m_SubscriptionsMutex };
+
+        const size_t subscriptionID = ++m_LastSubscriptionID;
+
+        m_Subscriptions[std::move(variablePath)].emplace_back(subscriptionID, std::move(callback));
+
+        return subscriptionID;
     }
-    ConfigFile::Parser::VariableIndicesInfo operator+(const ConfigFile::Parser::VariableIndicesInfo& lhs, ConfigFile::Parser::index rhs)
+    void ConfigFile::Watcher::Unsubscribe(size_t subscriptionID)
     {
-        return
-        {
-            lhs.type + rhs,
-            lhs.equals + rhs,
-            lhs.name + rhs,
-            lhs.value + rhs,
-            lhs.semicolon + rhs
-        };
+        const std::lock_guard lock{ m_SubscriptionsMutex };
+
+        for(auto subscriptions = m_Subscriptions.begin(); subscriptions != m_Subscriptions.end(); ++subscriptions)
+            if(std::erase_if(subscriptions->second, [subscriptionID](const auto& subscription) { return subscription.first == subscriptionID; }))
+            {
+                if(subscriptions->second.empty())
+                    m_Subscriptions.erase(subscriptions);
+
+                return;
+            }
     }
-}
-//ResourcesManager
-namespace GuelderResourcesManager
-{
-    ResourcesManager::ResourcesManager(std::filesystem::path executablePath)
-        : m_Path(std::move(executablePath))
+
+    void ConfigFile::Watcher::Reload()
     {
-        m_Path.remove_filename();
+        const std::lock_guard lock{ m_ReloadMutex };
+
+        std::shared_ptr<const Snapshot> newSnapshot = std::make_shared<const Snapshot>(LoadVariables(m_Path, m_StorageMode));
+
+        const std::shared_ptr<const Snapshot> oldSnapshot = m_SnapshotPublisher.Publish(newSnapshot);
+
+        //nullptr for the first load
+        if(oldSnapshot)
+            Notify(*oldSnapshot, *newSnapshot);
     }
 
-    std::string ResourcesManager::ReceiveFileSource(const std::filesystem::path& filePath)
+    void ConfigFile::Watcher::Run(std::stop_token stopToken, std::shared_ptr<std::promise<void>> watchStarted)
     {
-        std::ifstream file;
-        file.exceptions(std::ios::failbit | std::ios::badbit);
+        if(WatchWithInotify(stopToken, watchStarted))
+            return;
 
-        file.open(filePath, std::ios::binary);
+        WatchWithPolling(stopToken, watchStarted);
+    }
+    bool ConfigFile::Watcher::WatchWithInotify(const std::stop_token& stopToken, std::shared_ptr<std::promise<void>>& watchStarted)
+    {
+#ifdef __linux__
+        std::error_code errorCode;
 
-        std::stringstream source;//istringstream or stringstream?
-        source << file.rdbuf();
+        //the directory is watched, because SaveMode::Atomic replaces the file with another one
+        const std::filesystem::path filePath = std::filesystem::weakly_canonical(m_Path, errorCode);
 
-        file.close();
+        if(errorCode)
+            return false;
 
-        return source.str();
-    }
+        const std::filesystem::path directoryPath = filePath.has_parent_path() ? filePath.parent_path() : std::filesystem::path{ "." };
+        const std::string fileName = filePath.filename().string();
 
-    void ResourcesManager::AppendToFile(const std::filesystem::path& filePath, const std::string_view& append)
-    {
-        std::ofstream file;
-        file.exceptions(std::ios::failbit | std::ios::badbit);
+        const FileDescriptor inotify{ inotify_init1(IN_NONBLOCK | IN_CLOEXEC) };
+        const FileDescriptor stopEvent{ eventfd(0, EFD_CLOEXEC) };
 
-        file.open(filePath, std::ios::binary | std::ios::app);
+        if(inotify.fileDescriptor < 0 || stopEvent.fileDescriptor < 0)
+            return false;
+        if(inotify_add_watch(inotify.fileDescriptor, directoryPath.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+            return false;
 
-        //file << append;
-        file.write(append.data(), append.size());
+        const std::stop_callback stopCallback{ stopToken, [&stopEvent]
+            {
+                const uint64_t increment = 1;
+                [[maybe_unused]] const ssize_t bytesWritten = write(stopEvent.fileDescriptor, &increment, sizeof(increment));
+            } };
 
-        file.close();
-    }
-    void ResourcesManager::WriteToFile(const std::filesystem::path& filePath, const std::string_view& content)
-    {
-        std::ofstream file;
-        file.exceptions(std::ios::failbit | std::ios::badbit);
+        watchStarted->set_value();
+        watchStarted.reset();
 
-        file.open(filePath, std::ios::binary);
+        alignas(inotify_event) char events[4096];
 
-        file.write(content.data(), content.size());
-        //file << content;
+        pollfd fileDescriptors[2]{ { inotify.fileDescriptor, POLLIN, 0 }, { stopEvent.fileDescriptor, POLLIN, 0 } };
 
-        file.close();
+        while(!stopToken.stop_requested())
+        {
+            if(poll(fileDescriptors, 2, -1) < 0)
+            {
+                if(errno == EINTR)
+                    continue;
+
+                return false;
+            }
+
+            if(fileDescriptors[1].revents)
+                break;
+
+            bool hasFileChanged = false;
+
+            for(ssize_t eventsSize; (eventsSize = read(inotify.fileDescriptor, events, sizeof(events))) > 0;)
+                for(ssize_t offset = 0; offset < eventsSize;)
+                {
+                    const inotify_event* event = reinterpret_cast<const inotify_event*>(events + offset);
+
+                    //the directory itself is gone, polling will wait for the file to appear
+                    if(event->mask & IN_IGNORED)
+                        return false;
+                    if(event->mask & IN_Q_OVERFLOW || (event->len && fileName == event->name))
+                        hasFileChanged = true;
+
+                    offset += sizeof(inotify_event) + event->len;
+                }
+
+            if(hasFileChanged)
+                TryReload();
+        }
+
+        return true;
+#else
+        return false;
+#endif
     }
-    void ResourcesManager::WriteToFile(const std::filesystem::path& filePath, ConfigFile::Parser::index index, const std::string_view& content)
+    void ConfigFile::Watcher::WatchWithPolling(const std::stop_token& stopToken, std::shared_ptr<std::promise<void>>& watchStarted)
     {
-        std::string source = ReceiveFileSource(filePath);
+        std::mutex mutex;
+        std::condition_variable_any stopWaiter;
 
-        source.insert(index, content);
+        std::unique_lock lock{ mutex };
+
+        FileVersion fileVersion = ReceiveFileVersion(m_Path);
 
-        WriteToFile(filePath, source);
+        //if inotify has failed after starting, the snapshot is already loaded, so the file is reloaded to not miss a change
+        if(watchStarted)
+        {
+            watchStarted->set_value();
+            watchStarted.reset();
+        }
+        else
+            TryReload();
+
+        while(!stopToken.stop_requested())
+        {
+            const FileVersion currentFileVersion = ReceiveFileVersion(m_Path);
+
+            if(currentFileVersion != fileVersion)
+            {
+                fileVersion = currentFileVersion;
+
+                TryReload();
+            }
+
+            //wakes up right away when the stop is requested
+            stopWaiter.wait_for(lock, stopToken, m_PollingInterval, [] { return false; });
+        }
     }
 
-    std::filesystem::path ResourcesManager::GetFullPathToRelativeFile(const std::filesystem::path& relativePath) const
+    void ConfigFile::Watcher::TryReload() noexcept
     {
-        return m_Path / relativePath;
+        try
+        {
+            Reload();
+        }
+        catch(...)
+        {
+        }
     }
-
-    const std::filesystem::path& ResourcesManager::GetPath() const
+    void ConfigFile::Watcher::Notify(const Snapshot& oldSnapshot, const Snapshot& newSnapshot)
     {
-        return m_Path;
+        std::vector<std::pair<Callback, const Variable*>> callbacks;
+
+        {
+            const std::lock_guard lock{ m_SubscriptionsMutex };
+
+            for(const auto& [variablePath, subscriptions] : m_Subscriptions)
+            {
+                const Variable* oldVariable = oldSnapshot.FindVariable(variablePath);
+                const Variable* newVariable = newSnapshot.FindVariable(variablePath);
+
+                if(!oldVariable && !newVariable)
+                    continue;
+                if(oldVariable && newVariable && *oldVariable == *newVariable && oldVariable->IsArray() == newVariable->IsArray())
+                    continue;
+
+                for(const auto& subscription : subscriptions)
+                    callbacks.emplace_back(subscription.second, newVariable);
+            }
+        }
+
+        //outside of the lock, so a callback can subscribe or unsubscribe
+        for(const auto& [callback, variable] : callbacks)
+            callback(variable);
     }
-}
\ No newline at end of file
+}